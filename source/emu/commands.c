@@ -50,6 +50,12 @@ COMMAND_START
 	COMMAND(writecpu)
 	COMMAND(readppu)
 	COMMAND(dump)
+	COMMAND(bench)
+	COMMAND(ppubench)
+	COMMAND(tilebench)
+	COMMAND(frameskip)
+	COMMAND(trace)
+	COMMAND(profile)
 COMMAND_END
 
 COMMAND_FUNC(help)
@@ -56,6 +56,12 @@ COMMAND_DECL(loadstate);
 COMMAND_DECL(savestate);
 
 COMMAND_DECL(dump);
+COMMAND_DECL(bench);
+COMMAND_DECL(ppubench);
+COMMAND_DECL(tilebench);
+COMMAND_DECL(frameskip);
+COMMAND_DECL(trace);
+COMMAND_DECL(profile);
 
 int command_execute(char *str);
 
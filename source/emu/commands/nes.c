@@ -25,6 +25,10 @@
 #include "misc/log.h"
 #include "misc/config.h"
 #include "nes/nes.h"
+#include "nes/ppu/tilecache.h"
+#include "misc/memutil.h"
+#include "system/system.h"
+#include "system/video.h"
 
 //!!!!!! kludge alert !!!!!!
 extern int running;
@@ -181,4 +185,195 @@ COMMAND_FUNC(dump)
 	else
 		log_printf("please choose valid area and filename to save for dump\n");
 	return(0);
-}
\ No newline at end of file
+}
+
+COMMAND_FUNC(bench)
+{
+	u32 frames, n;
+	u64 t, cycles;
+	double secs;
+
+	CHECK_ARGS(2, "usage:  bench <frames>\n");
+	CHECK_CART();
+	frames = str2int(argv[1]);
+	if (frames == (u32)-1 || frames == 0) {
+		log_printf("invalid number of frames\n");
+		return(0);
+	}
+	cycles = nes->cpu.cycles;
+	t = system_gettick();
+	for (n = 0; n < frames; n++) {
+		video_startframe();
+		nes_frame();
+		video_endframe();
+	}
+	t = system_gettick() - t;
+	cycles = nes->cpu.cycles - cycles;
+	secs = (double)t / (double)system_getfrequency();
+	if (secs <= 0.0)
+		secs = 0.000001;
+	log_printf("bench:  %d frames in %.3f seconds, %.2f fps, %.2f emulated MHz\n", frames, secs, (double)frames / secs, (double)cycles / secs / 1000000.0);
+	return(0);
+}
+
+COMMAND_FUNC(ppubench)
+{
+	u32 frames;
+	u64 t, tdots;
+	double secs, secsdots;
+
+	CHECK_ARGS(2, "usage:  ppubench <frames>\n");
+	CHECK_CART();
+	frames = str2int(argv[1]);
+	if (frames == (u32)-1 || frames == 0) {
+		log_printf("invalid number of frames\n");
+		return(0);
+	}
+
+	//time the ppu alone, with whole lines drawn at once and dot by dot
+	t = system_gettick();
+	if (ppu_bench(frames, 1) != 0) {
+		log_printf("ppubench:  mapper watches the ppu bus, its state can't be restored\n");
+		return(0);
+	}
+	t = system_gettick() - t;
+	tdots = system_gettick();
+	ppu_bench(frames, 0);
+	tdots = system_gettick() - tdots;
+	secs = (double)t / (double)system_getfrequency();
+	secsdots = (double)tdots / (double)system_getfrequency();
+	log_printf("ppubench:  %d frames, %.1f us/frame (%.1f us/frame dot by dot)\n", frames, secs * 1000000.0 / frames, secsdots * 1000000.0 / frames);
+	return(0);
+}
+
+COMMAND_FUNC(frameskip)
+{
+	u32 n;
+
+	//no arguments, show the current setting
+	if (argc < 2) {
+		log_printf("frameskip:  %d\n", config_get_int("nes.frameskip"));
+		return(0);
+	}
+	n = str2int(argv[1]);
+	if (n == (u32)-1) {
+		log_printf("invalid number of frames\n");
+		return(0);
+	}
+	config_set_int("nes.frameskip", n);
+	log_printf("frameskip:  drawing one of every %d frames\n", n + 1);
+	return(0);
+}
+
+COMMAND_FUNC(tilebench)
+{
+	cachekernel_t *k;
+	u8 *chr;
+	cache_t *ref, *cache, *cache_hflip;
+	u32 passes, n, size = 0x40000, num = 0x40000 / 16;
+	u64 t;
+	double secs;
+
+	CHECK_ARGS(2, "usage:  tilebench <passes>\n");
+	passes = str2int(argv[1]);
+	if (passes == (u32)-1 || passes == 0) {
+		log_printf("invalid number of passes\n");
+		return(0);
+	}
+
+	//256kb of random chr, converted by the scalar kernel for reference
+	chr = (u8*)mem_alloc(size);
+	ref = (cache_t*)mem_alloc(size * 2);
+	cache = (cache_t*)mem_alloc(size);
+	cache_hflip = (cache_t*)mem_alloc(size);
+	for (n = 0; n < size; n++)
+		chr[n] = (u8)rand();
+	for (k = cache_kernels; k->name; k++);
+	k[-1].convert(chr, ref, ref + (size / 8), num);
+
+	//time each kernel the cpu supports, converting to both caches at once
+	for (k = cache_kernels; k->name; k++) {
+		if (k->supported() == 0) {
+			log_printf("tilebench:  %-8s not supported\n", k->name);
+			continue;
+		}
+		t = system_gettick();
+		for (n = 0; n < passes; n++)
+			k->convert(chr, cache, cache_hflip, num);
+		t = system_gettick() - t;
+		secs = (double)t / (double)system_getfrequency();
+		if (secs <= 0.0)
+			secs = 0.000001;
+		log_printf("tilebench:  %-8s %.2f ns/tile, %.1f mb/s%s%s\n", k->name, secs * 1000000000.0 / ((double)passes * num),
+			(double)passes * size / secs / (1024.0 * 1024.0), (k == cache_getkernel()) ? " (active)" : "",
+			(memcmp(cache, ref, size) || memcmp(cache_hflip, ref + (size / 8), size)) ? " MISMATCH" : "");
+	}
+	mem_free(chr);
+	mem_free(ref);
+	mem_free(cache);
+	mem_free(cache_hflip);
+	return(0);
+}
+
+COMMAND_FUNC(trace)
+{
+	u32 n;
+
+	CHECK_ARGS(2, "usage:  trace start [instructions] | stop | save <filename> | decode <filename> <textfile>\n");
+
+	//start recording, keeping the last 4m instructions by default
+	if (stricmp("start", argv[1]) == 0) {
+		n = (argc > 2) ? str2int(argv[2]) : 0x400000;
+		if (n == (u32)-1 || n == 0) {
+			log_printf("invalid number of instructions\n");
+			return(0);
+		}
+		cpu_trace_start(n);
+	}
+
+	else if (stricmp("stop", argv[1]) == 0)
+		cpu_trace_stop();
+
+	else if (stricmp("save", argv[1]) == 0) {
+		CHECK_ARGS(3, "usage:  trace save <filename>\n");
+		cpu_trace_save(argv[2]);
+	}
+
+	//decoding only needs the trace file, no cart has to be loaded
+	else if (stricmp("decode", argv[1]) == 0) {
+		CHECK_ARGS(4, "usage:  trace decode <filename> <textfile>\n");
+		cpu_trace_decode(argv[2], argv[3]);
+	}
+
+	else
+		log_printf("usage:  trace start [instructions] | stop | save <filename> | decode <filename> <textfile>\n");
+	return(0);
+}
+
+COMMAND_FUNC(profile)
+{
+	u32 n;
+
+	CHECK_ARGS(2, "usage:  profile start | stop | report [entries]\n");
+	CHECK_CART();
+
+	if (stricmp("start", argv[1]) == 0)
+		cpu_profile_start();
+
+	else if (stricmp("stop", argv[1]) == 0)
+		cpu_profile_stop();
+
+	//show the hottest instructions and routines, 20 of each by default
+	else if (stricmp("report", argv[1]) == 0) {
+		n = (argc > 2) ? str2int(argv[2]) : 20;
+		if (n == (u32)-1 || n == 0) {
+			log_printf("invalid number of entries\n");
+			return(0);
+		}
+		cpu_profile_report(n);
+	}
+
+	else
+		log_printf("usage:  profile start | stop | report [entries]\n");
+	return(0);
+}
@@ -81,15 +81,28 @@ static void write_reg(u32 addr,u8 data)
 	sync();
 }
 
-static void cpucycle()
+//cycles until the counter reaches zero
+static u32 irqcycles()
+{
+	return(irqcounter ? irqcounter : 0x10000);
+}
+
+static void cpuclock(u32 cycles)
 {
 	if(irqenabled == 0)
 	   return;
-	irqcounter--;
-	if(irqcounter == 0) {
-		irqenabled = 0;
-		cpu_set_irq(IRQ_MAPPER);
+	if(cycles < irqcycles()) {
+		irqcounter -= cycles;
+		return;
 	}
+	irqcounter = 0;
+	irqenabled = 0;
+	cpu_set_irq(IRQ_MAPPER);
+}
+
+static u32 cpuevent()
+{
+	return(irqenabled ? irqcycles() : EVENT_NEVER);
 }
 
 static void reset(int hard)
@@ -122,4 +135,4 @@ static void state(int mode,u8 *data)
 	sync();
 }
 
-MAPPER(B_IREM_H3001,reset,0,cpucycle,state);
+MAPPER_CPUIRQ(B_IREM_H3001,reset,0,cpuclock,cpuevent,state);
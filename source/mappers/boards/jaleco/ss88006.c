@@ -103,16 +103,26 @@ static void reset(int hard)
 	sync();
 }
 
-static void cpucycle()
+//the irq fires on the cycle the masked counter is zero, then the counter
+//restarts from the mask (clearing the bits above it)
+static void cpuclock(u32 cycles)
 {
-	if(irqcontrol & 1) {
-		if((irqcounter & irqmask) == 0) {
-			cpu_set_irq(IRQ_MAPPER);
-			irqcounter = 0;
-			irqcounter += irqmask + 1;
-		}
-		irqcounter--;
+	u32 n = (irqcounter & irqmask) + 1;
+
+	if((irqcontrol & 1) == 0)
+		return;
+	if(cycles < n) {
+		irqcounter -= cycles;
+		return;
 	}
+	cycles = (cycles - n) % ((u32)irqmask + 1);
+	irqcounter = irqmask - cycles;
+	cpu_set_irq(IRQ_MAPPER);
+}
+
+static u32 cpuevent()
+{
+	return((irqcontrol & 1) ? (irqcounter & irqmask) + 1 : EVENT_NEVER);
 }
 
 static void state(int mode,u8 *data)
@@ -127,4 +137,4 @@ static void state(int mode,u8 *data)
 	sync();
 }
 
-MAPPER(B_JALECO_SS88006,reset,0,cpucycle,state);
+MAPPER_CPUIRQ(B_JALECO_SS88006,reset,0,cpuclock,cpuevent,state);
@@ -107,16 +107,24 @@ static void reset(int hard)
 	sync();
 }
 
-static void cpucycle()
+//the irq fires on the cycle the counter is $FFFF, reloading it
+static void cpuclock(u32 cycles)
 {
+	u32 n = 0x10000 - irqcounter;
+
 	if((irqenable & 2) == 0)
 		return;
-	if(irqcounter == 0xFFFF) {
-		irqcounter = irqlatch;
-		cpu_set_irq(IRQ_MAPPER);
+	if(cycles < n) {
+		irqcounter += cycles;
+		return;
 	}
-	else
-		irqcounter++;
+	irqcounter = irqlatch + (cycles - n) % (0x10000 - irqlatch);
+	cpu_set_irq(IRQ_MAPPER);
+}
+
+static u32 cpuevent()
+{
+	return((irqenable & 2) ? 0x10000 - irqcounter : EVENT_NEVER);
 }
 
 static void state(int mode,u8 *data)
@@ -124,4 +132,4 @@ static void state(int mode,u8 *data)
 
 }
 
-MAPPER(B_KAISER_KS202,reset,0,cpucycle,state);
+MAPPER_CPUIRQ(B_KAISER_KS202,reset,0,cpuclock,cpuevent,state);
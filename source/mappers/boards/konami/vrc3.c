@@ -78,31 +78,37 @@ static void reset(int hard)
 	sync();
 }
 
-static void cpucycle()
+//mask of the counter bits that count (8bit mode leaves the high byte alone)
+static u32 irqmask()
 {
+	return((irqcontrol & 4) ? 0xFF : 0xFFFF);
+}
+
+//the irq fires on the cycle the counter is all ones, reloading it
+static void cpuclock(u32 cycles)
+{
+	u32 mask = irqmask();
+	u32 count = irqcounter & mask;
+	u32 reload = irqreload & mask;
+	u32 n = mask + 1 - count;
+
 	//see if it is enabled
 	if((irqcontrol & 2) == 0)
 		return;
-
-	//16bit mode
-	if((irqcontrol & 4) == 0) {
-		if(irqcounter == 0xFFFF) {
-			irqcounter = irqreload;
-			cpu_set_irq(IRQ_MAPPER);
-		}
-		else
-			irqcounter++;
+	if(cycles < n) {
+		irqcounter += cycles;
+		return;
 	}
+	cycles = (cycles - n) % (mask + 1 - reload);
+	irqcounter = (irqcounter & ~mask) | (reload + cycles);
+	cpu_set_irq(IRQ_MAPPER);
+}
 
-	//8bit mode
-	else {
-		if((irqcounter & 0xFF) == 0xFF) {
-			irqcounter = (irqcounter & 0xFF00) | (irqreload & 0xFF);
-			cpu_set_irq(IRQ_MAPPER);
-		}
-		else
-			irqcounter++;
-	}
+static u32 cpuevent()
+{
+	if((irqcontrol & 2) == 0)
+		return(EVENT_NEVER);
+	return(irqmask() + 1 - (irqcounter & irqmask()));
 }
 
 static void state(int mode,u8 *data)
@@ -114,4 +120,4 @@ static void state(int mode,u8 *data)
 	sync();
 }
 
-MAPPER(B_KONAMI_VRC3,reset,0,cpucycle,state);
+MAPPER_CPUIRQ(B_KONAMI_VRC3,reset,0,cpuclock,cpuevent,state);
@@ -26,4 +26,4 @@ static void reset(int hard)
 	namcot163_reset(namcot163_sync,hard);
 }
 
-MAPPER(B_NAMCOT_163,reset,0,namcot163_cpucycle,namcot163_state);
+MAPPER_CPUIRQ(B_NAMCOT_163,reset,0,namcot163_cpuclock,namcot163_cpuevent,namcot163_state);
@@ -89,15 +89,23 @@ static void reset(int hard)
 	sync();
 }
 
-static void cpucycle()
+//the irq fires on the cycle the counter is zero, then it wraps and stops
+static void cpuclock(u32 cycles)
 {
 	if(irqenable == 0)
 		return;
-	if(irqcounter == 0) {
-		irqenable = 0;
-		cpu_set_irq(IRQ_MAPPER);
+	if(cycles <= irqcounter) {
+		irqcounter -= cycles;
+		return;
 	}
-	irqcounter--;
+	irqenable = 0;
+	irqcounter = 0xFFFF;
+	cpu_set_irq(IRQ_MAPPER);
+}
+
+static u32 cpuevent()
+{
+	return(irqenable ? irqcounter + 1 : EVENT_NEVER);
 }
 
 static void state(int mode,u8 *data)
@@ -111,4 +119,4 @@ static void state(int mode,u8 *data)
 	sync();
 }
 
-MAPPER(B_SUNSOFT_3,reset,0,cpucycle,state);
+MAPPER_CPUIRQ(B_SUNSOFT_3,reset,0,cpuclock,cpuevent,state);
@@ -130,10 +130,17 @@ static void reset(int hard)
 	sync();
 }
 
-static void cpucycle()
+//the counter stops (control is cleared) once it reaches zero
+static void cpuclock(u32 cycles)
 {
+	u32 n = irqcounter ? irqcounter : 0x10000;
+
 	if(irqcontrol & 0x80) {
-		irqcounter--;
+		if(cycles < n) {
+			irqcounter -= cycles;
+			return;
+		}
+		irqcounter = 0;
 	}
 	if(irqcounter == 0) {
 		if(irqcontrol & 1)
@@ -142,6 +149,15 @@ static void cpucycle()
 	}
 }
 
+static u32 cpuevent()
+{
+	if((irqcontrol & 1) == 0)
+		return(EVENT_NEVER);
+	if(irqcontrol & 0x80)
+		return(irqcounter ? irqcounter : 0x10000);
+	return((irqcounter == 0) ? 1 : EVENT_NEVER);
+}
+
 static void state(int mode,u8 *data)
 {
 	STATE_ARRAY_U8(prg,4);
@@ -153,4 +169,4 @@ static void state(int mode,u8 *data)
 	sync();
 }
 
-MAPPER(B_SUNSOFT_5B,reset,0,cpucycle,state);
+MAPPER_CPUIRQ(B_SUNSOFT_5B,reset,0,cpuclock,cpuevent,state);
@@ -171,13 +171,22 @@ void namcot163_reset(void (*syncfunc)(),int hard)
 	sync();
 }
 
-void namcot163_cpucycle()
+//the counter runs while bit 15 is set, the irq fires when it wraps to zero
+void namcot163_cpuclock(u32 cycles)
 {
-	if(irqcounter >= 0x8000) {
-		irqcounter++;
-		if(irqcounter == 0)
-			cpu_set_irq(IRQ_MAPPER);
+	if(irqcounter < 0x8000)
+		return;
+	if(cycles < 0x10000 - (u32)irqcounter) {
+		irqcounter += cycles;
+		return;
 	}
+	irqcounter = 0;
+	cpu_set_irq(IRQ_MAPPER);
+}
+
+u32 namcot163_cpuevent()
+{
+	return((irqcounter >= 0x8000) ? 0x10000 - irqcounter : EVENT_NEVER);
 }
 
 void namcot163_state(int mode,u8 *data)
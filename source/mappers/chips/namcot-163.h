@@ -41,7 +41,8 @@
 void namcot163_sync();
 void namcot163_write(u32 addr,u8 data);
 void namcot163_reset(void (*syncfunc)(),int hard);
-void namcot163_cpucycle();
+void namcot163_cpuclock(u32 cycles);
+u32 namcot163_cpuevent();
 void namcot163_state(int mode,u8 *data);
 
 #endif
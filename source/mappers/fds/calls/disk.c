@@ -85,8 +85,7 @@ HLECALL(loadfiles)
 	u8 fileidlist[0x20];
 
 	//bios needs these flags set
-	nes->cpu.flags.z = 1;
-	nes->cpu.flags.n = 0;
+	cpu_set_nzflags(0,1);
 	nes->cpu.flags.v = 0;
 	nes->cpu.flags.c = 0;
 	nes->cpu.a = 0;
@@ -260,8 +259,7 @@ HLECALL(writefile)
 
 	nes->cpu.a = 0;
 	nes->cpu.x = 0;
-	nes->cpu.flags.n = 0;
-	nes->cpu.flags.z = 1;
+	cpu_set_nzflags(0,1);
 }
 
 HLECALL(appendfile)
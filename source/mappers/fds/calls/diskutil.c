@@ -26,7 +26,7 @@ HLECALL(xferdone)
 {
 	log_printf("xferdone:  not implemented\n");
 	//no error
-	if(nes->cpu.flags.z == 0) {
+	if(cpu_get_zflag() == 0) {
 		nes->cpu.a = (cpu_read(0xFA) & 9) | 0x26;
 		cpu_write(0xFA,nes->cpu.a);
 		cpu_write(0x4025,nes->cpu.a);
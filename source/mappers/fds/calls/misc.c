@@ -57,8 +57,7 @@ HLECALL(vintwait)
 	cpu_write(0x2000,tmp);
 
 	//clear zero flag, set negative flag
-	nes->cpu.flags.z = 0;
-	nes->cpu.flags.n = 1;
+	cpu_set_nzflags(1,0);
 
 	log_hle("vintwait!\n");
 }
@@ -45,8 +45,7 @@ HLECALL(readpads)
 	cpu_write(0x00,tmp2);
 	cpu_write(0xF6,tmp3);
 	cpu_write(0x01,tmp4);
-	nes->cpu.flags.z = 1;
-	nes->cpu.flags.n = 0;
+	cpu_set_nzflags(0,1);
 }
 
 HLECALL(readverifypads)
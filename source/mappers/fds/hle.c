@@ -318,7 +318,7 @@ void hlefds_write(u32 addr,u8 data)
 	}
 }
 
-#define READPAGE(addr)	nes->cpu.readpages[(addr) >> 10][(addr) & 0x3FF]
+#define READPAGE(addr)	nes->cpu.pages[(addr) >> 10].readptr[(addr) & 0x3FF]
 
 extern int showdisasm;
 
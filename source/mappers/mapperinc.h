@@ -27,6 +27,11 @@
 #define MAPPER(boardid,reset,ppucycle,cpucycle,state) \
 	mapper_t mapper##boardid = {boardid,reset,ppucycle,cpucycle,state}
 
+//mapper with a cpu cycle irq counter, clocked by the scheduler in batches
+//instead of every cycle
+#define MAPPER_CPUIRQ(boardid,reset,ppucycle,cpuclock,cpuevent,state) \
+	mapper_t mapper##boardid = {boardid,reset,ppucycle,0,state,cpuclock,cpuevent}
+
 #include "mappers/mappers.h"
 #include "mappers/mapperid.h"
 #include "nes/nes.h"
@@ -245,7 +245,9 @@ static mapper_t *get_mapper(int mapperid)
 	return(0);
 }
 
-static void null_mapper_cycle()				{}
+void null_mapper_cycle()						{}
+void null_mapper_clock(u32 cycles)			{}
+static u32 null_mapper_event()				{	return(EVENT_NEVER);	}
 static void null_mapper_state(int m,u8 *d){}
 
 #define check_null(var,nullfunc)	var = ((var == 0) ? nullfunc : var)
@@ -260,6 +262,8 @@ mapper_t *mapper_init(int mapperid)
 	}
 	check_null(ret->ppucycle,	null_mapper_cycle);
 	check_null(ret->cpucycle,	null_mapper_cycle);
+	check_null(ret->cpuclock,	null_mapper_clock);
+	check_null(ret->cpuevent,	null_mapper_event);
 	check_null(ret->state,		null_mapper_state);
 	return(ret);
 }
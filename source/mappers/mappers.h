@@ -29,6 +29,8 @@ typedef struct mapper_s {
 	void (*ppucycle)();			//ppu cycle handler
 	void (*cpucycle)();			//cpu cycle handler
 	void (*state)(int,u8*);		//load/save state information
+	void (*cpuclock)(u32);		//run the cpu cycle irq counter for a number of cycles
+	u32 (*cpuevent)();			//cycles until cpuclock raises an irq (EVENT_NEVER if it will not)
 } mapper_t;
 
 //converting from ines|ines20|unif to internal board id
@@ -42,4 +44,10 @@ const char *mapper_get_unif_boardname(int idx);
 //initialize mapper and get mapper_t struct
 mapper_t *mapper_init(int mapperid);
 
+//empty cycle handler used for mappers without one
+void null_mapper_cycle();
+
+//empty irq counter clock used for mappers without one
+void null_mapper_clock(u32 cycles);
+
 #endif
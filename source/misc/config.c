@@ -37,6 +37,9 @@
 
 static vars_t *configvars = 0;
 
+//cached config vars
+config_cache_t configcache;
+
 //this path stuff needs to be moved
 static void mkdirr(char *path)
 {
@@ -203,7 +206,12 @@ static vars_t *config_get_defaults()
 
 	vars_set_string(ret,F_CONFIG,"nes.region",					"ntsc");
 	vars_set_int   (ret,F_CONFIG,"nes.log_unhandled_io",		0);
+	vars_set_int   (ret,F_CONFIG,"nes.lazy_ppu",					1);
+	vars_set_int   (ret,F_CONFIG,"nes.idle_skip",					1);
+	vars_set_int   (ret,F_CONFIG,"nes.coarse_timing",			0);
 	vars_set_int   (ret,F_CONFIG,"nes.pause_on_load",			0);
+	vars_set_int   (ret,F_CONFIG,"nes.chr_hflip_cache",		1);
+	vars_set_int   (ret,F_CONFIG,"nes.frameskip",					0);
 
 	vars_set_int   (ret,F_CONFIG,"cartdb.enabled",				1);
 	vars_set_string(ret,F_CONFIG,"cartdb.filename",				"%path.xml%/NesCarts.xml;%path.xml%/NesCarts2.xml");
@@ -216,6 +224,12 @@ static vars_t *config_get_defaults()
 	return(ret);
 }
 
+static void update_cache()
+{
+	configcache.log_unhandled_io = config_get_bool("nes.log_unhandled_io");
+	configcache.frameskip = config_get_int("nes.frameskip");
+}
+
 int config_init()
 {
 	vars_t *v;
@@ -245,6 +259,7 @@ int config_init()
 	makepath(config_get_eval_string(tmp,"path.state"));
 	makepath(config_get_eval_string(tmp,"path.cheat"));
 
+	update_cache();
 	return(0);
 }
 
@@ -346,20 +361,21 @@ int config_get_bool(char *name)			{	return(vars_get_bool  (configvars,name,0));
 double config_get_double(char *name)	{	return(vars_get_double(configvars,name,0.0f));	}
 
 //set config var (wraps the vars_get_*() functions)
-void config_set_string(char *name,char *data)	{	vars_set_string(configvars,F_CONFIG,name,data);	}
-void config_set_int(char *name,int data)			{	vars_set_int   (configvars,F_CONFIG,name,data);	}
-void config_set_bool(char *name,int data)			{	vars_set_bool  (configvars,F_CONFIG,name,data);	}
-void config_set_double(char *name,double data)	{	vars_set_double(configvars,F_CONFIG,name,data);	}
+void config_set_string(char *name,char *data)	{	vars_set_string(configvars,F_CONFIG,name,data); update_cache();	}
+void config_set_int(char *name,int data)			{	vars_set_int   (configvars,F_CONFIG,name,data); update_cache();	}
+void config_set_bool(char *name,int data)			{	vars_set_bool  (configvars,F_CONFIG,name,data); update_cache();	}
+void config_set_double(char *name,double data)	{	vars_set_double(configvars,F_CONFIG,name,data); update_cache();	}
 
 //set var (wraps the vars_get_*() functions)
-void var_set_string(char *name,char *data)	{	vars_set_string(configvars,0,name,data);	}
-void var_set_int(char *name,int data)			{	vars_set_int   (configvars,0,name,data);	}
-void var_set_bool(char *name,int data)			{	vars_set_bool  (configvars,0,name,data);	}
-void var_set_double(char *name,double data)	{	vars_set_double(configvars,0,name,data);	}
+void var_set_string(char *name,char *data)	{	vars_set_string(configvars,0,name,data); update_cache();	}
+void var_set_int(char *name,int data)			{	vars_set_int   (configvars,0,name,data); update_cache();	}
+void var_set_bool(char *name,int data)			{	vars_set_bool  (configvars,0,name,data); update_cache();	}
+void var_set_double(char *name,double data)	{	vars_set_double(configvars,0,name,data); update_cache();	}
 
 void var_unset(char *name)
 {
 	vars_delete_var(configvars,name);
+	update_cache();
 }
 
 //semi-kludge for the 'set' command
@@ -23,6 +23,15 @@
 
 #include "misc/vars.h"
 
+//cached copies of config vars checked on hot paths, refreshed whenever
+//a var is set
+typedef struct config_cache_s {
+	int	log_unhandled_io;
+	int	frameskip;
+} config_cache_t;
+
+extern config_cache_t configcache;
+
 int config_init();
 void config_kill();
 void config_load();
@@ -135,6 +135,17 @@ void *memutil_dup(void *data,size_t size,char *file,int line)
 }
 
 void *memutil_alloc(size_t size,char *file,int line)
+{
+	void *ret = memutil_alloc_noclear(size,file,line);
+
+	if(ret)
+		memset(ret,0,size);
+	return(ret);
+}
+
+//same as memutil_alloc but the memory is left uninitialized, for buffers
+//that are filled in piece by piece as they are used
+void *memutil_alloc_noclear(size_t size,char *file,int line)
 {
 	void *ret;
 	int i;
@@ -144,7 +155,6 @@ void *memutil_alloc(size_t size,char *file,int line)
 		log_printf("memutil_alloc:  unable to alloc %d bytes\n", size);
 		exit(-1);
 	}
-	memset(ret,0,size);
 	num_alloc++;
 	num_bytes += size;
 	for(i=0;i<MAX_CHUNKS;i++) {
@@ -56,5 +56,7 @@ void apu_setexternal(external_t *ext);
 void apu_state(int mode,u8 *data);
 void apu_set_region(int r);
 void apu_dpcm_fetch();
+u32 apu_dpcm_nextevent();
+u32 apu_frame_nextevent();
 
 #endif
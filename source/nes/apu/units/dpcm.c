@@ -32,6 +32,57 @@ static u32 DPCMFreqPAL[16] = {
 
 static u32 *DpcmFreqTable;
 
+//put the cpu bus functions back once the fetch is done
+static void dpcm_dma_end()
+{
+	nes->cpu.read = nes->cpu.busread;
+	nes->cpu.write = nes->cpu.buswrite;
+}
+
+//cpu reads while a sample fetch is pending.  the access the fetch was
+//requested on goes through, the next read halts the cpu and is repeated
+//while the apu takes the bus (only once for the joypad registers).
+static u8 dpcm_dma_read(u32 addr)
+{
+	int n;
+
+	if(nes->cpu.cycles == dpcm.dmastart)
+		return(nes->cpu.busread(addr));
+	n = dpcm.dmacycles - 1;
+	dpcm_dma_end();
+
+	//this access has already been ticked
+	if(n--) {
+		nes->cpu.busread(addr);
+		while(n--) {
+			cpu_tick();
+			if(addr != 0x4016 && addr != 0x4017)
+				nes->cpu.busread(addr);
+		}
+		apu_dpcm_fetch();
+		cpu_tick();
+	}
+	else
+		apu_dpcm_fetch();
+	return(nes->cpu.busread(addr));
+}
+
+//the cpu cannot be halted on a write, each one delays the fetch a cycle
+static void dpcm_dma_write(u32 addr,u8 data)
+{
+	if(nes->cpu.cycles != dpcm.dmastart && --dpcm.dmacycles == 0)
+		dpcm_dma_end();
+	nes->cpu.buswrite(addr,data);
+}
+
+static INLINE void dpcm_dma_start()
+{
+	dpcm.dmacycles = 4;
+	dpcm.dmastart = nes->cpu.cycles;
+	nes->cpu.read = dpcm_dma_read;
+	nes->cpu.write = dpcm_dma_write;
+}
+
 static INLINE void apu_dpcm_reset(int hard)
 {
 	dpcm.freq = dpcm.wavehold = dpcm.doirq = dpcm.pcmdata = dpcm.addr = dpcm.len = 0;
@@ -45,6 +96,8 @@ static INLINE void apu_dpcm_reset(int hard)
 	dpcm.bufempty = 1;
 	dpcm.fetching = 0;
 	dpcm.outbits = 8;
+	if(nes->cpu.read == dpcm_dma_read)
+		dpcm_dma_end();
 }
 
 static INLINE void apu_dpcm_write(u32 addr,u8 data)
@@ -114,17 +167,28 @@ static INLINE void apu_dpcm_step()
 	if (dpcm.bufempty && !dpcm.fetching && dpcm.LengthCtr)
 	{
 		dpcm.fetching = 1;
-		nes->cpu.pcmcycles = 4;
+		dpcm_dma_start();
 //		CPU::PCMCycles = 4;
 		// decrement LengthCtr now, so $4015 reads are updated in time
 		dpcm.LengthCtr--;
 	}
 }
 
+//cycles until the next sample fetch is requested
+u32 apu_dpcm_nextevent()
+{
+	if(dpcm.fetching || dpcm.LengthCtr == 0)
+		return(EVENT_NEVER);
+	if(dpcm.bufempty)
+		return(1);
+	return(dpcm.Cycles + (dpcm.outbits - 1) * DpcmFreqTable[dpcm.freq]);
+}
+
 void apu_dpcm_fetch()
 {
 	dpcm.buffer = cpu_read(dpcm.CurAddr);
 	cpu_tick();
+	scheduler_sync();
 	dpcm.bufempty = 0;
 	dpcm.fetching = 0;
 	if (++dpcm.CurAddr == 0x10000)
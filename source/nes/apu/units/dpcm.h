@@ -30,6 +30,10 @@ typedef struct dpcm_s {
 	u32 LengthCtr;
 	u32 Cycles;
 	s32 Pos;
+
+	//sample fetch dma, cycles left to steal and the cycle it was requested on
+	u8 dmacycles;
+	u64 dmastart;
 } dpcm_t;
 
 #endif
@@ -55,6 +55,21 @@ static INLINE void apu_frame_write(u32 addr,u8 data)
 //	log_printf("apu_frame_write:  lengthcounter = %02X (cycle %d, line %d, frame %d)\n",data,LINECYCLES,SCANLINE,FRAMES);
 }
 
+//cycles until the frame counter can next raise its irq
+u32 apu_frame_nextevent()
+{
+	//irq being raised or counter being reset
+	if(FRAME_IRQ || FRAME_ZERO)
+		return(1);
+
+	//5-step mode or irq inhibited
+	if(FRAME_REG != 0)
+		return(EVENT_NEVER);
+	if(FRAME_CYCLES > FrameCycles[3])
+		return(1);
+	return(FrameCycles[3] - FRAME_CYCLES + 1);
+}
+
 static INLINE void apu_frame_step()
 {
 	if(FRAME_CYCLES == FrameCycles[0]) {
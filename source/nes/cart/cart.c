@@ -26,6 +26,7 @@
 #include "misc/paths.h"
 #include "misc/crc32.h"
 #include "misc/memfile.h"
+#include "misc/config.h"
 #include "nes/cart/cart.h"
 #include "nes/cart/ines.h"
 #include "nes/cart/ines20.h"
@@ -196,13 +197,14 @@ cart_t *cart_load_patched(const char *filename,const char *patchfilename)
 
 	//tile cache stuff
 	if(ret->chr.size) {
-		//allocate memory for the tile cache
-		ret->cache = (cache_t*)mem_alloc(ret->chr.size);
-		ret->cache_hflip = (cache_t*)mem_alloc(ret->chr.size);
-
-		//convert all chr tiles to cache tiles
-		cache_tiles(ret->chr.data,ret->cache,ret->chr.size / 16,0);
-		cache_tiles(ret->chr.data,ret->cache_hflip,ret->chr.size / 16,1);
+		//allocate memory for the tile cache.  pages are converted the first
+		//time they are mapped in (see mem_setchr) and cachevalid guards every
+		//read, so the cache isn't cleared and pages never used are never touched.
+		ret->cache = (cache_t*)mem_alloc_noclear(ret->chr.size);
+		if(config_get_bool("nes.chr_hflip_cache"))
+			ret->cache_hflip = (cache_t*)mem_alloc_noclear(ret->chr.size);
+		n = (ret->chr.size / 0x400 + 7) / 8;
+		ret->cachevalid = (u8*)mem_alloc(n);
 	}
 
 	//see if title exists and clean it up
@@ -266,8 +268,10 @@ void cart_unload(cart_t *r)
 		FREE_DATA(r->diskoriginal);
 		FREE(r->cache);
 		FREE(r->cache_hflip);
+		FREE(r->cachevalid);
 		FREE(r->vcache);
 		FREE(r->vcache_hflip);
+		FREE(r->vdirty);
 		FREE(r->filename);
 		patch_unload(r->patch);
 		FREE(r);
@@ -321,4 +325,6 @@ void cart_setvramsize(cart_t *r,int banks)
 	//tile cache data
 	r->vcache = (cache_t*)ram_alloc(r->vram.size,r->vcache);
 	r->vcache_hflip = (cache_t*)ram_alloc(r->vram.size,r->vcache_hflip);
+	r->vdirty = (u32*)ram_alloc(r->vram.size / 16 / 8,r->vdirty);
+	memset(r->vdirty,0,r->vram.size / 16 / 8);
 }
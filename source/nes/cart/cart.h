@@ -94,8 +94,10 @@ typedef struct cart_s {
 	u8			data[0x80];
 
 	//cached tile data
-	cache_t	*cache,*cache_hflip;			//chr cache
+	cache_t	*cache,*cache_hflip;			//chr cache (hflip is optional)
+	u8			*cachevalid;					//bitmap of converted 1kb chr pages
 	cache_t	*vcache,*vcache_hflip;		//vram cache
+	u32		*vdirty;							//bitmap of vram tiles written since last cached
 	
 	//loaded file's name
 	char		*filename;
@@ -21,7 +21,7 @@
 //implied addressing
 static INLINE void AM_IMP()
 {
-	TMPREG = memread(PC);
+	TMPREG = memfetch(PC);
 }
 
 //immediate addressing
@@ -33,8 +33,8 @@ static INLINE void AM_IMM()
 //absolute addressing
 static INLINE void AM_ABS()
 {
-	EFFADDR = memread(PC++);
-	EFFADDR |= memread(PC++) << 8;
+	EFFADDR = memfetch(PC++);
+	EFFADDR |= memfetch(PC++) << 8;
 }
 
 /*
@@ -53,8 +53,10 @@ Notes: I denotes either index register (X or Y).
 //absolute x addressing (for reading only)
 static INLINE void AM_AXR()
 {
-	EFFADDR = memread(PC++);
-	EFFADDR |= memread(PC++) << 8;
+	int tmpi;
+
+	EFFADDR = memfetch(PC++);
+	EFFADDR |= memfetch(PC++) << 8;
 	tmpi = (EFFADDR & 0xFF) + X;
 	if(tmpi >= 0x100) {
 		memread((EFFADDR & 0xFF00) | (u8)tmpi);
@@ -65,8 +67,10 @@ static INLINE void AM_AXR()
 //absolute x addressing
 static INLINE void AM_ABX()
 {
-	EFFADDR = memread(PC++);
-	EFFADDR |= memread(PC++) << 8;
+	int tmpi;
+
+	EFFADDR = memfetch(PC++);
+	EFFADDR |= memfetch(PC++) << 8;
 	tmpi = (EFFADDR & 0xFF) + X;
 	memread((EFFADDR & 0xFF00) | (u8)tmpi);
 	EFFADDR += X;
@@ -75,8 +79,10 @@ static INLINE void AM_ABX()
 //absolute y addressing (for reading only)
 static INLINE void AM_AYR()
 {
-	EFFADDR = memread(PC++);
-	EFFADDR |= memread(PC++) << 8;
+	int tmpi;
+
+	EFFADDR = memfetch(PC++);
+	EFFADDR |= memfetch(PC++) << 8;
 	tmpi = (EFFADDR & 0xFF) + Y;
 	if(tmpi >= 0x100) {
 		memread((EFFADDR & 0xFF00) | (u8)tmpi);
@@ -87,8 +93,10 @@ static INLINE void AM_AYR()
 //absolute y addressing
 static INLINE void AM_ABY()
 {
-	EFFADDR = memread(PC++);
-	EFFADDR |= memread(PC++) << 8;
+	int tmpi;
+
+	EFFADDR = memfetch(PC++);
+	EFFADDR |= memfetch(PC++) << 8;
 	tmpi = (EFFADDR & 0xFF) + Y;
 	memread((EFFADDR & 0xFF00) | (u8)tmpi);
 	EFFADDR += Y;
@@ -97,13 +105,13 @@ static INLINE void AM_ABY()
 //zero-page addressing
 static INLINE void AM_ZPG()
 {
-	EFFADDR = memread(PC++);
+	EFFADDR = memfetch(PC++);
 }
 
 //zero-page x addressing
 static INLINE void AM_ZPX()
 {
-	EFFADDR = memread(PC++);
+	EFFADDR = memfetch(PC++);
 	memread(EFFADDR);
 	EFFADDR = (EFFADDR + X) & 0xFF;
 }
@@ -111,7 +119,7 @@ static INLINE void AM_ZPX()
 //zero-page y addressing
 static INLINE void AM_ZPY()
 {
-	EFFADDR = memread(PC++);
+	EFFADDR = memfetch(PC++);
 	memread(EFFADDR);
 	EFFADDR = (EFFADDR + Y) & 0xFF;
 }
@@ -131,7 +139,7 @@ Note: The effective address is always fetched from zero page, i.e. the zero page
 //indirect x
 static INLINE void AM_INX()
 {
-	TMPREG = memread(PC++);
+	TMPREG = memfetch(PC++);
 	memread(TMPREG);
 	TMPREG += X;
 	EFFADDR = memread(TMPREG++);
@@ -155,7 +163,9 @@ Notes: The effective address is always fetched from zero page, i.e. the zero pag
 //indirect y (for reading only)
 static INLINE void AM_IYR()
 {
-	TMPREG = memread(PC++);
+	int tmpi;
+
+	TMPREG = memfetch(PC++);
 	EFFADDR = memread(TMPREG++);
 	EFFADDR |= memread(TMPREG) << 8;
 	tmpi = (EFFADDR & 0xFF) + Y;
@@ -181,7 +191,9 @@ Notes: The effective address is always fetched from zero page, i.e. the zero pag
 //indirect y
 static INLINE void AM_INY()
 {
-	TMPREG = memread(PC++);
+	int tmpi;
+
+	TMPREG = memfetch(PC++);
 	EFFADDR = memread(TMPREG++);
 	EFFADDR |= memread(TMPREG) << 8;
 	tmpi = (EFFADDR & 0xFF) + Y;
@@ -192,8 +204,8 @@ static INLINE void AM_INY()
 //indirect addressing
 static INLINE void AM_IND()
 {
-	TMPADDR = memread(PC++);
-	TMPADDR |= memread(PC++) << 8;
+	TMPADDR = memfetch(PC++);
+	TMPADDR |= memfetch(PC++) << 8;
 	EFFADDR = memread(TMPADDR);
 	TMPADDR = (TMPADDR & 0xFF00) | ((TMPADDR + 1) & 0xFF);
 	EFFADDR |= memread(TMPADDR) << 8;
@@ -202,7 +214,7 @@ static INLINE void AM_IND()
 //relative addressing
 static INLINE void AM_REL()
 {
-	TMPREG = memread(PC++);
+	TMPREG = memfetch(PC++);
 }
 
 //unknown addressing (for bad opcodes, and jsr)
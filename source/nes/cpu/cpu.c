@@ -38,11 +38,10 @@
 #define TMPADDR			nes->cpu.tmpaddr
 #define EFFADDR			nes->cpu.effaddr
 #define FLAG_C				nes->cpu.flags.c
-#define FLAG_Z				nes->cpu.flags.z
 #define FLAG_I				nes->cpu.flags.i
 #define FLAG_D				nes->cpu.flags.d
 #define FLAG_V				nes->cpu.flags.v
-#define FLAG_N				nes->cpu.flags.n
+#define FLAG_NZ			nes->cpu.flags.nz
 #define OPCODE				nes->cpu.opcode
 #define OPADDR				nes->cpu.opaddr
 #define TMPREG				nes->cpu.tmpreg
@@ -54,26 +53,25 @@
 
 #define BADOPCODE			nes->cpu.badopcode
 
-//cpu memory read/write functions
-readfunc_t cpu_read;
-writefunc_t cpu_write;
-
-//temp variable for opcode functions
-static u8 tmp8;
-static int tmpi;
-
-//pal hack
-static int palticks;
-
 //for stopping execution when invalid opcodes are encountered (kludge)
 extern int running;
 
+//default memory read/write functions
+static u8 read_cpu_memory(u32 addr);
+static void write_cpu_memory(u32 addr,u8 data);
+
 //include helper functions
 #include "helper.c"
 
 //include addressing mode functions
 #include "addrmodes.c"
 
+//include idle loop detection
+#include "idle.c"
+
+//include sprite dma
+#include "dma.c"
+
 //include opcode functions
 #include "opcodes/misc.c"
 #include "opcodes/branch.c"
@@ -94,7 +92,6 @@ extern int running;
 
 int cpu_init()
 {
-	palticks = 0;
 	cpu_disassemble_init();
 	state_register(B_CPU,cpu_state);
 	return(0);
@@ -102,6 +99,8 @@ int cpu_init()
 
 void cpu_kill()
 {
+	cpu_trace_stop();
+	cpu_profile_stop();
 }
 
 void cpu_reset(int hard)
@@ -109,12 +108,16 @@ void cpu_reset(int hard)
 	int i;
 
 	for(i=0;i<8;i+=2) {
-		nes->cpu.readpages[i + 0] = nes->cpu.writepages[i + 0] = (u8*)nes->cpu.ram;
-		nes->cpu.readpages[i + 1] = nes->cpu.writepages[i + 1] = (u8*)nes->cpu.ram + 0x400;
+		nes->cpu.pages[i + 0].readptr = nes->cpu.pages[i + 0].writeptr = (u8*)nes->cpu.ram;
+		nes->cpu.pages[i + 1].readptr = nes->cpu.pages[i + 1].writeptr = (u8*)nes->cpu.ram + 0x400;
 	}
 
-	nes->cpu.pcmcycles = 0;
 	nes->cpu.badopcode = 0;
+	nes->cpu.idle.addr = 0;
+	nes->cpu.idle.clean = 0;
+	nes->cpu.idle.next = 0;
+	nes->cpu.idle.enabled = (config_get_bool("nes.idle_skip") && nes->mapper->cpucycle == null_mapper_cycle) ? 1 : 0;
+	nes->cpu.coarse = (config_get_bool("nes.coarse_timing") && nes->mapper->cpucycle == null_mapper_cycle) ? 1 : 0;
 	if(hard) {
 		A = X = Y = 0;
 		SP = 0xFD;
@@ -159,18 +162,14 @@ void cpu_clear_irq(u8 state)
 	IRQSTATE &= ~state;
 }
 
-static INLINE void ppu_tick()
+u8 cpu_get_zflag()
 {
-	if(nes->region->id & REGION_PAL) {
-		palticks++;
-		if(palticks == 5) {
-			palticks = 0;
-			ppu_step();
-		}
-	}
-	ppu_step();
-	ppu_step();
-	ppu_step();
+	return(FLAG_Z);
+}
+
+void cpu_set_nzflags(u8 n,u8 z)
+{
+	FLAG_NZ = (n ? 0x800 : 0) | (z ? 0 : 1);
 }
 
 void cpu_tick()
@@ -182,54 +181,63 @@ void cpu_tick()
 	//increment cycle counter for every memory access
 	CYCLES++;
 
-	//catch up the ppu
-	ppu_tick();
+	//catch up the ppu/apu if an event is due
+	if(CYCLES >= nes->scheduler.next)
+		scheduler_step();
 
-	//catch up the apu
-	apu_step();
-
-	//call the mapper callback
-	nes->mapper->cpucycle();
+	//mappers without an irq event still see every cycle
+	if(nes->mapper->cpucycle != null_mapper_cycle)
+		nes->mapper->cpucycle();
 }
 
 static u8 read_cpu_memory(u32 addr)
 {
 	u32 page = addr >> 10;
+	cpupage_t *p = &nes->cpu.pages[page];
 
 	//see if this page is handled by a memory pointer
-	if(nes->cpu.readpages[page] != 0) {
-		return(nes->cpu.readpages[page][addr & 0x3FF]);
+	if(p->readptr != 0) {
+		return(p->readptr[addr & 0x3FF]);
 	}
 
 	//see if this page is handled by a read function
-	if(nes->cpu.readfuncs[page] != 0) {
-		return(nes->cpu.readfuncs[page](addr));
+	if(p->readfunc != 0) {
+		if((addr & 0xE007) == 0x2002)
+			nes->cpu.idle.ppustatus = 1;
+		else
+			nes->cpu.idle.clean = 0;
+
+		//only the ppu/apu registers and a mapper irq counter can see time pass
+		if(addr < 0x4020 || nes->mapper->cpuclock != null_mapper_clock)
+			scheduler_sync();
+		return(p->readfunc(addr));
 	}
 
 	//not handled
-	if(config_get_bool("nes.log_unhandled_io"))
+	if(configcache.log_unhandled_io)
 		log_printf("cpu_read:  unhandled read at $%04X (page %d)\n",addr,page);
 	return(0);
 }
 
 static void write_cpu_memory(u32 addr,u8 data)
 {
-	u32 page = addr >> 10;
+	cpupage_t *p = &nes->cpu.pages[addr >> 10];
 
 	//see if this page is handled by a memory pointer
-	if(nes->cpu.writepages[page] != 0) {
-		nes->cpu.writepages[page][addr & 0x3FF] = data;
+	if(p->writeptr != 0) {
+		p->writeptr[addr & 0x3FF] = data;
 		return;
 	}
 
-	//see if this page is handled by a read function
-	if(nes->cpu.writefuncs[page] != 0) {
-		nes->cpu.writefuncs[page](addr,data);
+	//see if this page is handled by a write function
+	if(p->writefunc != 0) {
+		scheduler_sync();
+		p->writefunc(addr,data);
 		return;
 	}
 
 	//not handled
-	if(config_get_bool("nes.log_unhandled_io"))
+	if(configcache.log_unhandled_io)
 		log_printf("cpu_write:  unhandled write at $%04X = $%02X\n",addr,data);
 }
 
@@ -239,24 +247,39 @@ u8 cpu_getflags()
 	return(P);
 }
 
+u8 cpu_read(u32 addr)
+{
+	return(nes->cpu.busread(addr));
+}
+
+void cpu_write(u32 addr,u8 data)
+{
+	nes->cpu.buswrite(addr,data);
+}
+
 readfunc_t cpu_getreadfunc()
 {
-	return(cpu_read);
+	return(nes->cpu.busread);
 }
 
 writefunc_t cpu_getwritefunc()
 {
-	return(cpu_write);
+	return(nes->cpu.buswrite);
 }
 
+//a pending dpcm fetch keeps its hook and picks up the new function after
 void cpu_setreadfunc(readfunc_t readfunc)
 {
-	cpu_read = (readfunc == 0) ? read_cpu_memory : readfunc;
+	if(nes->cpu.read == nes->cpu.busread)
+		nes->cpu.read = (readfunc == 0) ? read_cpu_memory : readfunc;
+	nes->cpu.busread = (readfunc == 0) ? read_cpu_memory : readfunc;
 }
 
 void cpu_setwritefunc(writefunc_t writefunc)
 {
-	cpu_write = (writefunc == 0) ? write_cpu_memory : writefunc;
+	if(nes->cpu.write == nes->cpu.buswrite)
+		nes->cpu.write = (writefunc == 0) ? write_cpu_memory : writefunc;
+	nes->cpu.buswrite = (writefunc == 0) ? write_cpu_memory : writefunc;
 }
 
 void cpu_state(int mode,u8 *data)
@@ -271,4 +294,8 @@ void cpu_state(int mode,u8 *data)
 	STATE_U8(PREV_NMISTATE);
 	STATE_U8(PREV_IRQSTATE);
 	STATE_ARRAY_U8(nes->cpu.ram,0x800);
+	if(mode == STATE_LOAD) {
+		nes->cpu.idle.clean = 0;
+		scheduler_reset();
+	}
 }
@@ -22,6 +22,17 @@
 #define __nes__cpu_h__
 
 #include "types.h"
+#include "nes/cpu/trace.h"
+#include "nes/cpu/profile.h"
+
+//memory map entry for a 1kb page.  accesses use the pointer when it is set,
+//otherwise the handler function.
+typedef struct cpupage_s {
+	u8				*readptr;
+	readfunc_t	readfunc;
+	u8				*writeptr;
+	writefunc_t	writefunc;
+} cpupage_t;
 
 typedef struct cpu_s {
 
@@ -33,7 +44,11 @@ typedef struct cpu_s {
 
 	//seperated flags register
 	struct {
-		u8	c,z,i,d,b,v,n;
+		u8	c,i,d,b,v;
+
+		//n/z are derived from the last result when needed.  z is set when the
+		//low byte is zero, n when bit 7 or bit 11 is set (so both can be set).
+		u16	nz;
 	} flags;
 
 	//interrupt flags
@@ -57,24 +72,42 @@ typedef struct cpu_s {
 	//internal memory
 	u8		ram[0x800];
 
-	//memory access pointers
-	u8		*readpages[64];
-	u8		*writepages[64];
+	//memory map
+	cpupage_t	pages[64];
 
-	//memory access functions
-	readfunc_t	readfuncs[64];
-	writefunc_t	writefuncs[64];
+	//memory read/write functions (default or hooked by genie/mapper)
+	readfunc_t	busread;
+	writefunc_t	buswrite;
 
-	//kludge for apu pcm cycle stealing
-	u32	pcmcycles;
+	//read/write functions used by the core, the bus functions above unless
+	//the apu is stealing cycles for a dpcm sample fetch
+	readfunc_t	read;
+	writefunc_t	write;
 
 	//bad opcode counter
 	int	badopcode;
 
-} cpu_t;
+	//coarse timing, events and interrupts are only checked between instructions
+	u8		coarse;
+
+	//idle loop detection
+	struct {
+		u16	addr;				//branch target the loop is watched at
+		u64	cycles;			//cycle count at the start of the iteration
+		u64	next;				//next event at the start of the iteration
+		u8		a,x,y,sp,p;		//registers at the start of the iteration
+		u8		clean;			//nothing written or read from i/o this iteration
+		u8		ppustatus;		//$2002 was read this iteration
+		u8		enabled;
+	} idle;
 
-extern readfunc_t cpu_read;
-extern writefunc_t cpu_write;
+	//instruction trace
+	trace_t		trace;
+
+	//profiler
+	profile_t	profile;
+
+} cpu_t;
 
 int cpu_init();
 void cpu_kill();
@@ -84,10 +117,16 @@ void cpu_set_nmi();
 void cpu_clear_nmi();
 void cpu_set_irq(u8 state);
 void cpu_clear_irq(u8 state);
+u8 cpu_get_zflag();
+void cpu_set_nzflags(u8 n,u8 z);
 void cpu_tick();
+void cpu_oam_dma(u8 page);
+u8 cpu_read(u32 addr);
+void cpu_write(u32 addr,u8 data);
 u32 cpu_execute(u32 cycles);
 void cpu_execute_frame();
 u16 cpu_disassemble(char *buffer, u16 opcodepos);
+u16 cpu_disassemble_bytes(char *buffer,u16 opcodepos,u8 *bytes);
 void cpu_disassemble_init();
 readfunc_t cpu_getreadfunc();
 writefunc_t cpu_getwritefunc();
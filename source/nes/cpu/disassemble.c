@@ -107,45 +107,64 @@ static u8 addrtable[256] = {
 
 static u8 oplength[256];
 
-u16 cpu_disassemble(char *buffer,u16 opcodepos)
+//disassemble one instruction from its opcode and operand bytes
+static u16 disassemble(char *buffer,u16 opcodepos,u8 *bytes)
 {
 	u8 opcode,size;
 	u16 addr;
 
 	strcpy(buffer,"");
-	opcode = cpu_read(opcodepos);
+	opcode = bytes[0];
 	switch(addrtable[opcode]) {
 		case er:size = 1;sprintf(buffer,"%02X       .db $%02x",opcode,opcode);break;
 		case no:size = 1;sprintf(buffer,"%02X       %s",opcode,opcodes[opcode]);break;
 		case ac:size = 1;sprintf(buffer,"%02X       %s a",opcode,opcodes[opcode]);break;
 		case ab:
 			size = 3;
-			addr = cpu_read(opcodepos+1) | (cpu_read(opcodepos+2) << 8);
+			addr = bytes[1] | (bytes[2] << 8);
 			sprintf(buffer,"%02X %02X %02X %s $%04X",opcode,addr & 0xFF,(addr >> 8) & 0xFF,opcodes[opcode],addr);
 			break;
 		case ax:
 			size = 3;
-			addr = cpu_read(opcodepos+1) | (cpu_read(opcodepos+2) << 8);
+			addr = bytes[1] | (bytes[2] << 8);
 			sprintf(buffer,"%02X %02X %02X %s $%04X,x",opcode,addr & 0xFF,(addr >> 8) & 0xFF,opcodes[opcode],addr);
 			break;
 		case ay:
 			size = 3;
-			addr = cpu_read(opcodepos+1) | (cpu_read(opcodepos+2) << 8);
+			addr = bytes[1] | (bytes[2] << 8);
 			sprintf(buffer,"%02X %02X %02X %s $%04X,y",opcode,addr & 0xFF,(addr >> 8) & 0xFF,opcodes[opcode],addr);
 			break;
-		case in:size = 3;sprintf(buffer,"%02X %02X %02X %s ($%04X)",opcode,cpu_read(opcodepos+1),cpu_read(opcodepos+2),opcodes[opcode],cpu_read(opcodepos+1) | (cpu_read(opcodepos+2) << 8));break;
-		case im:size = 2;sprintf(buffer,"%02X %02X    %s #$%02X",opcode,cpu_read(opcodepos+1),opcodes[opcode],cpu_read(opcodepos+1));break;
-		case ix:size = 2;sprintf(buffer,"%02X %02X    %s ($%02X,x)",opcode,cpu_read(opcodepos+1),opcodes[opcode],cpu_read(opcodepos+1));break;
-		case iy:size = 2;sprintf(buffer,"%02X %02X    %s ($%02X),y",opcode,cpu_read(opcodepos+1),opcodes[opcode],cpu_read(opcodepos+1));break;
-		case re:size = 2;sprintf(buffer,"%02X %02X    %s $%04X",opcode,cpu_read(opcodepos+1),opcodes[opcode],opcodepos+size+((s8)cpu_read(opcodepos+1)));break;
-		case zp:size = 2;sprintf(buffer,"%02X %02X    %s $%02X",opcode,cpu_read(opcodepos+1),opcodes[opcode],cpu_read(opcodepos+1));break;
-		case zx:size = 2;sprintf(buffer,"%02X %02X    %s $%02X,x",opcode,cpu_read(opcodepos+1),opcodes[opcode],cpu_read(opcodepos+1));break;
-		case zy:size = 2;sprintf(buffer,"%02X %02X    %s $%02X,y",opcode,cpu_read(opcodepos+1),opcodes[opcode],cpu_read(opcodepos+1));break;
+		case in:size = 3;sprintf(buffer,"%02X %02X %02X %s ($%04X)",opcode,bytes[1],bytes[2],opcodes[opcode],bytes[1] | (bytes[2] << 8));break;
+		case im:size = 2;sprintf(buffer,"%02X %02X    %s #$%02X",opcode,bytes[1],opcodes[opcode],bytes[1]);break;
+		case ix:size = 2;sprintf(buffer,"%02X %02X    %s ($%02X,x)",opcode,bytes[1],opcodes[opcode],bytes[1]);break;
+		case iy:size = 2;sprintf(buffer,"%02X %02X    %s ($%02X),y",opcode,bytes[1],opcodes[opcode],bytes[1]);break;
+		case re:size = 2;sprintf(buffer,"%02X %02X    %s $%04X",opcode,bytes[1],opcodes[opcode],opcodepos+size+((s8)bytes[1]));break;
+		case zp:size = 2;sprintf(buffer,"%02X %02X    %s $%02X",opcode,bytes[1],opcodes[opcode],bytes[1]);break;
+		case zx:size = 2;sprintf(buffer,"%02X %02X    %s $%02X,x",opcode,bytes[1],opcodes[opcode],bytes[1]);break;
+		case zy:size = 2;sprintf(buffer,"%02X %02X    %s $%02X,y",opcode,bytes[1],opcodes[opcode],bytes[1]);break;
 		default:size = 1;sprintf(buffer,"disassembler bug");break;
 	}
 	return(opcodepos + size);
 }
 
+u16 cpu_disassemble(char *buffer,u16 opcodepos)
+{
+	u8 bytes[3] = {0,0,0};
+	int i;
+
+	//only read the bytes the instruction has, reads can have side effects
+	bytes[0] = cpu_read(opcodepos);
+	for(i=1;i<oplength[bytes[0]];i++)
+		bytes[i] = cpu_read((u16)(opcodepos + i));
+	return(disassemble(buffer,opcodepos,bytes));
+}
+
+//disassemble from a copy of the opcode bytes (for the cpu trace)
+u16 cpu_disassemble_bytes(char *buffer,u16 opcodepos,u8 *bytes)
+{
+	return(disassemble(buffer,opcodepos,bytes));
+}
+
 void cpu_disassemble_init()
 {
 	int i;
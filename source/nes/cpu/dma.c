@@ -0,0 +1,68 @@
+/***************************************************************************
+ *   Copyright (C) 2013 by James Holodnak                                  *
+ *   jamesholodnak@gmail.com                                               *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+//run the clock forward, jumping straight to the cycle before the next
+//scheduled event when nothing needs to see every cycle
+static INLINE void dma_advance(u32 n)
+{
+	u64 skip;
+
+	while(n) {
+		if(nes->mapper->cpucycle == null_mapper_cycle && nes->scheduler.next > CYCLES + 1) {
+			skip = nes->scheduler.next - CYCLES - 1;
+			if(skip > n - 1)
+				skip = n - 1;
+			CYCLES += skip;
+			n -= (u32)skip;
+		}
+		cpu_tick();
+		n--;
+	}
+}
+
+//sprite dma ($4014).  the cpu is halted for a cycle (two on odd cycles) and
+//then the page is copied with a read and a write to $2004 for each byte.
+void cpu_oam_dma(u8 page)
+{
+	u8 *src = nes->cpu.pages[page >> 2].readptr;
+	u32 addr = page << 8;
+	u32 align = 1 + ((u32)CYCLES & 1);
+	u8 data;
+	int i;
+
+	//plain memory page, nothing can see the individual accesses
+	if(src && nes->cpu.busread == read_cpu_memory && nes->cpu.buswrite == write_cpu_memory &&
+		nes->cpu.pages[0x2004 >> 10].writefunc == ppu_write) {
+		src += addr & 0x3FF;
+		scheduler_sync();
+		ppu_oamwrite(src);
+		dma_advance(align + 512);
+		return;
+	}
+
+	//i/o source, interleave the reads and writes with the clock
+	dma_advance(align);
+	for(i=0;i<256;i++) {
+		cpu_tick();
+		data = cpu_read(addr + i);
+		cpu_tick();
+		cpu_write(0x2004,data);
+	}
+}
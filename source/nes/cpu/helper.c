@@ -18,45 +18,53 @@
  *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
  ***************************************************************************/
 
-static INLINE u8 memread(u32 addr)
+//advance a cycle for a memory access.  with coarse timing only the cycle
+//counter moves here, the rest is caught up after each instruction.
+static INLINE void bus_tick()
 {
-	static int n;
-
-	//handle dpcm cycle stealing
-	if(nes->cpu.pcmcycles) {
-		n = nes->cpu.pcmcycles - 1;
-		nes->cpu.pcmcycles = 0;
-		if(addr == 0x4016 || addr == 0x4017) {
-			if(n--)
-				memread(addr);
-			while(n--)
-				cpu_tick();
-		}
-		else {
-			while(n--)
-				memread(addr);
-		}
-		apu_dpcm_fetch();
-	}
+	if(nes->cpu.coarse)
+		CYCLES++;
+	else
+		cpu_tick();
+}
 
+static INLINE u8 memread(u32 addr)
+{
 	//increment cycle counter, check irq lines
-	cpu_tick();
+	bus_tick();
 
 	//read data from address
-	return(cpu_read(addr));
+	return(nes->cpu.read(addr));
+}
+
+//read from the instruction stream.  code nearly always runs from plain memory
+//pages, so the read function is skipped unless something is hooking reads.
+static INLINE u8 memfetch(u32 addr)
+{
+	u8 *page;
+
+	if(nes->cpu.read != read_cpu_memory)
+		return(memread(addr));
+
+	//increment cycle counter, check irq lines
+	bus_tick();
+
+	//read opcode/operand directly from the page
+	if((page = nes->cpu.pages[addr >> 10].readptr) != 0)
+		return(page[addr & 0x3FF]);
+	return(nes->cpu.read(addr));
 }
 
 static INLINE void memwrite(u32 addr,u8 data)
 {
-	//handle dpcm cycle stealing
-	if(nes->cpu.pcmcycles)
-		nes->cpu.pcmcycles--;
+	//memory has changed, loop iteration cannot be skipped
+	nes->cpu.idle.clean = 0;
 
 	//increment cycle counter, check irq lines
-	cpu_tick();
+	bus_tick();
 
 	//write data to its address
-	cpu_write(addr,data);
+	nes->cpu.write(addr,data);
 }
 
 //push data to stack
@@ -73,32 +81,32 @@ static INLINE u8 pop()
 	return(memread(SP | 0x100));
 }
 
-//check value for n/z and set flags
+//n/z flags from the last result
+#define FLAG_N		((FLAG_NZ & 0x880) ? 1 : 0)
+#define FLAG_Z		((FLAG_NZ & 0xFF) ? 0 : 1)
+
+//save value for n/z flags
 static INLINE void checknz(u8 n)
 {
-	FLAG_N = (n >> 7) & 1;
-	FLAG_Z = (n == 0) ? 1 : 0;
+	FLAG_NZ = n;
 }
 
 static INLINE void expand_flags()
 {
 	FLAG_C = (P & 0x01) >> 0;
-	FLAG_Z = (P & 0x02) >> 1;
+	FLAG_NZ = ((P & 0x80) << 4) | ((P & 0x02) ^ 0x02);
 	FLAG_I = (P & 0x04) >> 2;
 	FLAG_D = (P & 0x08) >> 3;
 	FLAG_V = (P & 0x40) >> 6;
-	FLAG_N = (P & 0x80) >> 7;
 }
 
 static INLINE void compact_flags()
 {
 #ifdef CPU_DEBUG
 	if(FLAG_C & 0xFE || 
-		FLAG_Z & 0xFE ||
 		FLAG_I & 0xFE ||
 		FLAG_D & 0xFE ||
-		FLAG_V & 0xFE ||
-		FLAG_N & 0xFE) {
+		FLAG_V & 0xFE) {
 		log_printf("compact_flags:  one or more flags is dirty!\n");
 	}
 #endif
@@ -113,8 +121,10 @@ static INLINE void compact_flags()
 
 static INLINE void execute_nmi()
 {
-	memread(PC);
-	memread(PC);
+	if(nes->cpu.profile.enabled)
+		cpu_profile_interrupt(PC);
+	memfetch(PC);
+	memfetch(PC);
 	push((u8)(PC >> 8));
 	push((u8)PC);
 	compact_flags();
@@ -126,8 +136,10 @@ static INLINE void execute_nmi()
 
 static INLINE void execute_irq()
 {
-	memread(PC);
-	memread(PC);
+	if(nes->cpu.profile.enabled)
+		cpu_profile_interrupt(PC);
+	memfetch(PC);
+	memfetch(PC);
 	push((u8)(PC >> 8));
 	push((u8)PC);
 	compact_flags();
@@ -0,0 +1,119 @@
+/***************************************************************************
+ *   Copyright (C) 2013 by James Holodnak                                  *
+ *   jamesholodnak@gmail.com                                               *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+/*
+Idle loop detection.  Every backward branch or jump marks the start of a loop
+iteration at its target.  When the cpu lands on the same target again with the
+same registers and nothing was written or read from an i/o page in between,
+the next iteration will do exactly the same thing, and so will every one after
+it until something outside the cpu changes.  That can only be an interrupt or
+a scheduled event, so whole iterations are skipped up to just before the next
+event by advancing the cycle counter.
+
+Reads of $2002 are allowed for the usual "LDA/BIT $2002, BPL/BMI" vblank wait,
+since the only bit that can end the loop is the vblank flag, which is set by
+a scheduled event.
+*/
+
+#define IDLE				nes->cpu.idle
+
+static INLINE u8 idle_flags()
+{
+	return(FLAG_C | (FLAG_Z << 1) | (FLAG_I << 2) | (FLAG_D << 3) | (FLAG_V << 6) | (FLAG_N << 7));
+}
+
+//start watching a new iteration at the current pc
+static INLINE void idle_start()
+{
+	IDLE.addr = PC;
+	IDLE.cycles = CYCLES;
+	IDLE.a = A;
+	IDLE.x = X;
+	IDLE.y = Y;
+	IDLE.sp = SP;
+	IDLE.p = idle_flags();
+	IDLE.clean = 1;
+	IDLE.ppustatus = 0;
+}
+
+//see if the loop is a two instruction $2002 poll testing the vblank flag
+static int idle_ppustatus_loop()
+{
+	u8 *page = nes->cpu.pages[PC >> 10].readptr;
+
+	if(OPADDR != (u16)(PC + 3) || page == 0)
+		return(0);
+	if(OPCODE != 0x10 && OPCODE != 0x30)
+		return(0);
+	switch(page[PC & 0x3FF]) {
+		case 0x2C:	//bit
+		case 0xAD:	//lda
+		case 0xAE:	//ldx
+		case 0xAC:	//ldy
+			return(1);
+	}
+	return(0);
+}
+
+static void idle_skip()
+{
+	u32 period = (u32)(CYCLES - IDLE.cycles);
+	u64 next,n;
+
+	//these all see every cycle, so nothing can be skipped
+	if(nes->scheduler.eager || nes->cpu.read != read_cpu_memory || (IDLE.ppustatus && idle_ppustatus_loop() == 0)) {
+		IDLE.next = 0;
+		return;
+	}
+
+	//the event pending at the start of the iteration must not have been
+	//reached during it, otherwise this iteration saw something new.
+	next = scheduler_nextevent();
+	if(IDLE.next > CYCLES && next > CYCLES + period) {
+
+		//run whole iterations up to one before the next event
+		n = (next - CYCLES - 1) / period;
+		if(n > 1) {
+			CYCLES += (n - 1) * period;
+			if(nes->cpu.profile.enabled)
+				cpu_profile_idle((n - 1) * period);
+		}
+	}
+	IDLE.next = next;
+}
+
+//called after a branch or jump backwards
+static INLINE void idle_check()
+{
+	if(IDLE.enabled == 0 && nes->cpu.profile.enabled == 0)
+		return;
+	if(PC == IDLE.addr && IDLE.clean && PREV_NMISTATE == 0 && PREV_IRQSTATE == 0 &&
+		A == IDLE.a && X == IDLE.x && Y == IDLE.y && SP == IDLE.sp && idle_flags() == IDLE.p) {
+		if(nes->cpu.profile.enabled)
+			cpu_profile_idle(CYCLES - IDLE.cycles);
+		if(IDLE.enabled)
+			idle_skip();
+		else
+			IDLE.next = 0;
+	}
+	else
+		IDLE.next = 0;
+	idle_start();
+}
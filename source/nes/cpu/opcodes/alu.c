@@ -55,6 +55,8 @@ static INLINE void OP_ASLA()
 
 static INLINE void OP_ROL()
 {
+	u8 tmp8;
+
 	TMPREG = memread(EFFADDR);
 	memwrite(EFFADDR,TMPREG);
 	tmp8 = FLAG_C;
@@ -74,6 +76,8 @@ static INLINE void OP_ROLA()
 
 static INLINE void OP_ROR()
 {
+	u8 tmp8;
+
 	TMPREG = memread(EFFADDR);
 	memwrite(EFFADDR,TMPREG);
 	tmp8 = FLAG_C;
@@ -110,6 +114,8 @@ static INLINE void OP_LSRA()
 
 static INLINE void OP_ADC()
 {
+	int tmpi;
+
 	TMPREG = memread(EFFADDR);
 	tmpi = A + TMPREG + FLAG_C;
 	FLAG_C = (tmpi & 0xFF00) ? 1 : 0;
@@ -120,6 +126,8 @@ static INLINE void OP_ADC()
 
 static INLINE void OP_SBC()
 {
+	int tmpi;
+
 	TMPREG = memread(EFFADDR);
 	tmpi = A - TMPREG - (1 - FLAG_C);
 	FLAG_C = ((tmpi & 0xFF00) == 0) ? 1 : 0;
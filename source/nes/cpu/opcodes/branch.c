@@ -37,22 +37,24 @@ static INLINE void BRANCH(int n)
 {
 	if(n == 0)
 		return;
-	memread(PC);
+	memfetch(PC);
 	TMPADDR = PC + (s8)TMPREG;
 	if((TMPADDR ^ PC) & 0xFF00) {
 		memread((PC & 0xFF00) | (TMPADDR & 0xFF));
 	}
 	PC = TMPADDR;
+	if(PC <= OPADDR)
+		idle_check();
 }
 
 static INLINE void OP_BMI()
 {
-	BRANCH(FLAG_N);
+	BRANCH(FLAG_NZ & 0x880);
 }
 
 static INLINE void OP_BPL()
 {
-	BRANCH((~FLAG_N) & 1);
+	BRANCH((FLAG_NZ & 0x880) == 0);
 }
 
 static INLINE void OP_BVS()
@@ -77,10 +79,10 @@ static INLINE void OP_BCC()
 
 static INLINE void OP_BEQ()
 {
-	BRANCH(FLAG_Z);
+	BRANCH((FLAG_NZ & 0xFF) == 0);
 }
 
 static INLINE void OP_BNE()
 {
-	BRANCH((~FLAG_Z) & 1);
+	BRANCH(FLAG_NZ & 0xFF);
 }
@@ -22,12 +22,13 @@ static INLINE void OP_BIT()
 {
 	TMPREG = memread(EFFADDR);
 	FLAG_V = (TMPREG >> 6) & 1;
-	FLAG_N = (TMPREG >> 7) & 1;
-	FLAG_Z = (A & TMPREG) ? 0 : 1;
+	FLAG_NZ = ((TMPREG & 0x80) << 4) | (A & TMPREG);
 }
 
 static INLINE void OP_CMP()
 {
+	int tmpi;
+
 	tmpi = A - memread(EFFADDR);
 	FLAG_C = (tmpi >= 0) ? 1 : 0;
 	checknz((u8)tmpi);
@@ -35,6 +36,8 @@ static INLINE void OP_CMP()
 
 static INLINE void OP_CPX()
 {
+	int tmpi;
+
 	tmpi = X - memread(EFFADDR);
 	FLAG_C = (tmpi >= 0) ? 1 : 0;
 	checknz((u8)tmpi);
@@ -42,6 +45,8 @@ static INLINE void OP_CPX()
 
 static INLINE void OP_CPY()
 {
+	int tmpi;
+
 	tmpi = Y - memread(EFFADDR);
 	FLAG_C = (tmpi >= 0) ? 1 : 0;
 	checknz((u8)tmpi);
@@ -20,6 +20,8 @@
 
 static INLINE void OP_DEC()
 {
+	u8 tmp8;
+
 	tmp8 = memread(EFFADDR);
 	memwrite(EFFADDR,tmp8--);
 	memwrite(EFFADDR,tmp8);
@@ -40,6 +42,8 @@ static INLINE void OP_DEY()
 
 static INLINE void OP_INC()
 {
+	u8 tmp8;
+
 	tmp8 = memread(EFFADDR);
 	memwrite(EFFADDR,tmp8++);
 	memwrite(EFFADDR,tmp8);
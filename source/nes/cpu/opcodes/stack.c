@@ -50,7 +50,7 @@ static INLINE void OP_RTS()
 	memread(SP | 0x100);
 	PC = pop();
 	PC |= pop() << 8;
-	memread(PC++);
+	memfetch(PC++);
 }
 
 static INLINE void OP_RTI()
@@ -66,6 +66,8 @@ static INLINE void OP_RTI()
 static INLINE void OP_JMP()
 {
 	PC = EFFADDR;
+	if(PC <= OPADDR)
+		idle_check();
 }
 
 static INLINE void OP_JSR()
@@ -74,7 +76,7 @@ static INLINE void OP_JSR()
 	memread(SP | 0x100);
 	push((u8)(PC >> 8));
 	push((u8)PC);
-	PC = (memread(PC) << 8) | TMPREG;
+	PC = (memfetch(PC) << 8) | TMPREG;
 }
 
 /*
@@ -32,6 +32,9 @@ static INLINE void OP_SAX()
 
 static INLINE void OP_DCP()
 {
+	u8 tmp8;
+	int tmpi;
+
 	tmp8 = memread(EFFADDR);
 	memwrite(EFFADDR,tmp8--);
 	memwrite(EFFADDR,tmp8);
@@ -42,6 +45,9 @@ static INLINE void OP_DCP()
 
 static INLINE void OP_ISB()
 {
+	u8 tmp8;
+	int tmpi;
+
 	tmp8 = memread(EFFADDR);
 	memwrite(EFFADDR,tmp8++);
 	memwrite(EFFADDR,tmp8);
@@ -65,6 +71,8 @@ static INLINE void OP_SLO()
 
 static INLINE void OP_RLA()
 {
+	u8 tmp8;
+
 	TMPREG = memread(EFFADDR);
 	memwrite(EFFADDR,TMPREG);
 	tmp8 = FLAG_C;
@@ -88,6 +96,9 @@ static INLINE void OP_SRE()
 
 static INLINE void OP_RRA()
 {
+	u8 tmp8;
+	int tmpi;
+
 	TMPREG = memread(EFFADDR);
 	memwrite(EFFADDR,TMPREG);
 	tmp8 = FLAG_C;
@@ -136,6 +147,8 @@ static INLINE void OP_ATX()
 
 static INLINE void OP_AXS()
 {
+	int tmpi;
+
 	tmpi = (X & A) - memread(EFFADDR);
 	X = (u8)tmpi;
 	checknz(X);
@@ -147,6 +160,8 @@ static INLINE void OP_AXS()
 
 static INLINE void OP_SYA()
 {
+	u8 tmp8;
+
 	tmp8 = Y & ((EFFADDR >> 8) + 1);
 	if((X + memread(OPADDR + 1)) <= 0xFF)
 		memwrite(EFFADDR,tmp8);
@@ -154,6 +169,8 @@ static INLINE void OP_SYA()
 
 static INLINE void OP_SXA()
 {
+	u8 tmp8;
+
 	tmp8 = X & ((EFFADDR >> 8) + 1);
 	if((Y + memread(OPADDR + 1)) <= 0xFF)
 		memwrite(EFFADDR,tmp8);
@@ -161,18 +178,24 @@ static INLINE void OP_SXA()
 
 static INLINE void OP_LAR()
 {
+	u8 tmp8;
+
 	tmp8 = memread(EFFADDR) & SP;
 	A = X = SP = tmp8;
 }
 
 static INLINE void OP_AXA()
 {
+	u8 tmp8;
+
 	tmp8 = (A & X) & 7;
 	memwrite(EFFADDR,tmp8);
 }
 
 static INLINE void OP_XAS()
 {
+	u8 tmp8;
+
 	SP = A & X;
 	tmp8 = SP & (EFFADDR >> 8);
 	memwrite(EFFADDR,tmp8);
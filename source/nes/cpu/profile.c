@@ -0,0 +1,240 @@
+/***************************************************************************
+ *   Copyright (C) 2013 by James Holodnak                                  *
+ *   jamesholodnak@gmail.com                                               *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include "nes/nes.h"
+#include "misc/log.h"
+#include "misc/memutil.h"
+
+//size of the hash tables (power of two), one more entry is allocated past
+//the end for everything that doesnt fit
+#define TABLE_SIZE	0x10000
+
+//longest probe sequence before giving up on an entry
+#define MAX_PROBE		32
+
+#define PROFILE		nes->cpu.profile
+
+//prg page mapped at an address
+static u32 profile_key(u32 addr)
+{
+	u8 *ptr = nes->cpu.pages[addr >> 10].readptr;
+	u32 page = PROFILE_NOPRG;
+
+	if(ptr >= nes->cart->prg.data && ptr < nes->cart->prg.data + nes->cart->prg.size)
+		page = (u32)(ptr - nes->cart->prg.data) >> 10;
+	return((page << 16) | addr);
+}
+
+//find (or add) the entry for a key
+static profentry_t *profile_find(profentry_t *table,u32 key)
+{
+	u32 hash = (key ^ (key >> 13)) * 0x9E3779B1;
+	u32 i,n;
+
+	for(n=0;n<MAX_PROBE;n++) {
+		i = (hash + n) & (TABLE_SIZE - 1);
+		if(table[i].used == 0) {
+			table[i].used = 1;
+			table[i].key = key;
+			return(&table[i]);
+		}
+		if(table[i].key == key)
+			return(&table[i]);
+	}
+
+	//too crowded here, lump it in with the others
+	return(&table[TABLE_SIZE]);
+}
+
+static void profile_call(u32 key)
+{
+	if(PROFILE.depth < 64)
+		PROFILE.stack[PROFILE.depth] = key;
+	PROFILE.depth++;
+	profile_find(PROFILE.routines,key)->count++;
+}
+
+//follow the call stack after the last instruction, key is where it went
+static void profile_flow(u32 key)
+{
+	switch(PROFILE.lastopcode) {
+		case 0x20:	//jsr
+			profile_call(key);
+			break;
+		case 0x40:	//rti
+		case 0x60:	//rts
+			if(PROFILE.depth > 0)
+				PROFILE.depth--;
+			break;
+	}
+}
+
+int cpu_profile_start()
+{
+	if(nes->cart == 0) {
+		log_printf("cpu_profile_start:  no cart loaded\n");
+		return(1);
+	}
+	cpu_profile_stop();
+	PROFILE.pcs = (profentry_t*)mem_alloc((TABLE_SIZE + 1) * sizeof(profentry_t));
+	PROFILE.routines = (profentry_t*)mem_alloc((TABLE_SIZE + 1) * sizeof(profentry_t));
+	if(PROFILE.pcs == 0 || PROFILE.routines == 0) {
+		log_printf("cpu_profile_start:  unable to allocate the profile tables\n");
+		cpu_profile_stop();
+		return(1);
+	}
+	PROFILE.lastkey = profile_key(nes->cpu.pc);
+	PROFILE.lastcycle = nes->cpu.cycles;
+	PROFILE.lastopcode = 0xEA;
+
+	//everything until the first call goes to the routine we are in
+	PROFILE.stack[0] = PROFILE.lastkey;
+	PROFILE.depth = 1;
+	PROFILE.framestart = nes->cpu.cycles;
+	PROFILE.frameidle = 0;
+	PROFILE.frames = 0;
+	PROFILE.busy = 0.0f;
+	PROFILE.busymin = 1.0f;
+	PROFILE.busymax = 0.0f;
+	PROFILE.enabled = 1;
+	return(0);
+}
+
+void cpu_profile_stop()
+{
+	if(PROFILE.pcs)
+		mem_free(PROFILE.pcs);
+	if(PROFILE.routines)
+		mem_free(PROFILE.routines);
+	PROFILE.pcs = PROFILE.routines = 0;
+	PROFILE.enabled = 0;
+}
+
+//called before each instruction, the previous one is charged its cycles
+void cpu_profile_instruction(u32 addr,u8 opcode)
+{
+	u32 cycles = (u32)(nes->cpu.cycles - PROFILE.lastcycle);
+	profentry_t *e = profile_find(PROFILE.pcs,PROFILE.lastkey);
+	int top = PROFILE.depth - 1;
+
+	e->count++;
+	e->cycles += cycles;
+	if(top >= 0 && top < 64)
+		profile_find(PROFILE.routines,PROFILE.stack[top])->cycles += cycles;
+
+	PROFILE.lastkey = profile_key(addr);
+	PROFILE.lastcycle = nes->cpu.cycles;
+	profile_flow(PROFILE.lastkey);
+	PROFILE.lastopcode = opcode;
+}
+
+//nmi/irq taken with the pc at addr, the handler is treated as a routine
+void cpu_profile_interrupt(u32 addr)
+{
+	profile_flow(profile_key(addr));
+	PROFILE.lastopcode = 0x20;
+}
+
+//cycles spent spinning in an idle loop
+void cpu_profile_idle(u64 cycles)
+{
+	PROFILE.frameidle += cycles;
+}
+
+void cpu_profile_frame()
+{
+	u64 total = nes->cpu.cycles - PROFILE.framestart;
+	double busy;
+
+	if(total == 0)
+		return;
+	busy = (PROFILE.frameidle >= total) ? 0.0f : (double)(total - PROFILE.frameidle) / (double)total;
+	PROFILE.busy += busy;
+	if(PROFILE.busymin > busy)
+		PROFILE.busymin = busy;
+	if(PROFILE.busymax < busy)
+		PROFILE.busymax = busy;
+	PROFILE.frames++;
+	PROFILE.framestart = nes->cpu.cycles;
+	PROFILE.frameidle = 0;
+}
+
+static int compare_cycles(const void *a,const void *b)
+{
+	const profentry_t *e1 = (const profentry_t*)a;
+	const profentry_t *e2 = (const profentry_t*)b;
+
+	if(e1->cycles == e2->cycles)
+		return(0);
+	return((e1->cycles < e2->cycles) ? 1 : -1);
+}
+
+static void report_table(char *name,profentry_t *table,int num,u64 total)
+{
+	profentry_t *sorted;
+	char page[8];
+	u32 key;
+	int i,n;
+
+	sorted = (profentry_t*)mem_alloc((TABLE_SIZE + 1) * sizeof(profentry_t));
+	for(i=n=0;i<TABLE_SIZE;i++) {
+		if(table[i].used)
+			sorted[n++] = table[i];
+	}
+	qsort(sorted,n,sizeof(profentry_t),compare_cycles);
+	log_printf("hottest %s:\n",name);
+	log_printf("  prg   addr        cycles      pct       count\n");
+	for(i=0;i<n && i<num;i++) {
+		key = sorted[i].key;
+		if((key >> 16) == PROFILE_NOPRG)
+			strcpy(page,"  -");
+		else
+			sprintf(page,"%3d",key >> 16);
+		log_printf("  %s  $%04X  %12llu  %6.2f%%  %10u\n",page,key & 0xFFFF,
+			(unsigned long long)sorted[i].cycles,total ? (double)sorted[i].cycles * 100.0f / (double)total : 0.0f,sorted[i].count);
+	}
+	if(table[TABLE_SIZE].cycles || table[TABLE_SIZE].count)
+		log_printf("  (overflow)  %12llu  %6.2f%%  %10u\n",(unsigned long long)table[TABLE_SIZE].cycles,
+			total ? (double)table[TABLE_SIZE].cycles * 100.0f / (double)total : 0.0f,table[TABLE_SIZE].count);
+	mem_free(sorted);
+}
+
+void cpu_profile_report(int num)
+{
+	u64 total = 0;
+	int i;
+
+	if(PROFILE.enabled == 0) {
+		log_printf("cpu_profile_report:  profiler is not running\n");
+		return;
+	}
+	for(i=0;i<=TABLE_SIZE;i++)
+		total += PROFILE.pcs[i].cycles;
+	log_printf("profiled %llu cycles over %d frames (prg is the 1kb page number)\n",(unsigned long long)total,PROFILE.frames);
+	report_table("instructions",PROFILE.pcs,num,total);
+	report_table("routines (own cycles)",PROFILE.routines,num,total);
+	if(PROFILE.frames) {
+		log_printf("cpu utilisation per frame (cycles not spent in idle loops):\n");
+		log_printf("  avg %.1f%%  min %.1f%%  max %.1f%%\n",PROFILE.busy * 100.0f / PROFILE.frames,
+			PROFILE.busymin * 100.0f,PROFILE.busymax * 100.0f);
+	}
+}
@@ -0,0 +1,69 @@
+/***************************************************************************
+ *   Copyright (C) 2013 by James Holodnak                                  *
+ *   jamesholodnak@gmail.com                                               *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#ifndef __nes__cpu__profile_h__
+#define __nes__cpu__profile_h__
+
+#include "types.h"
+
+//profiler keys are the cpu address in the low 16 bits and the 1kb prg page
+//mapped there in the upper bits (PROFILE_NOPRG for ram/wram/registers)
+#define PROFILE_NOPRG	0xFFFF
+
+//counters for one address
+typedef struct profentry_s {
+	u32	key;
+	u32	count;			//instructions executed/routine calls
+	u64	cycles;
+	u8		used;				//entry holds a key
+} profentry_t;
+
+typedef struct profile_s {
+	int			enabled;
+
+	//per instruction and per routine counters (hash tables)
+	profentry_t	*pcs;
+	profentry_t	*routines;
+
+	//instruction being timed
+	u32			lastkey;
+	u64			lastcycle;
+	u8				lastopcode;
+
+	//shadow call stack, routine keys
+	u32			stack[64];
+	int			depth;
+
+	//frame utilisation
+	u64			framestart;
+	u64			frameidle;
+	u32			frames;
+	double		busy,busymin,busymax;
+} profile_t;
+
+int cpu_profile_start();
+void cpu_profile_stop();
+void cpu_profile_instruction(u32 addr,u8 opcode);
+void cpu_profile_interrupt(u32 addr);
+void cpu_profile_idle(u64 cycles);
+void cpu_profile_frame();
+void cpu_profile_report(int num);
+
+#endif
@@ -0,0 +1,267 @@
+/***************************************************************************
+ *   Copyright (C) 2013 by James Holodnak                                  *
+ *   jamesholodnak@gmail.com                                               *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include "nes/nes.h"
+#include "misc/log.h"
+#include "misc/memutil.h"
+
+//header of a saved trace file
+#define TRACE_IDENT	"NTRC"
+
+//size of an entry in a saved trace, the fields are stored little endian
+#define TRACE_ENTRYSIZE	18
+
+//largest number of instructions kept (about 512mb of buffers)
+#define TRACE_MAXSIZE	0x1000000
+
+#define TRACE		nes->cpu.trace
+
+//start recording, size is rounded up to a power of two
+int cpu_trace_start(u32 size)
+{
+	u32 n = 1;
+
+	cpu_trace_stop();
+	if(size > TRACE_MAXSIZE) {
+		log_printf("cpu_trace_start:  %u instructions is too many, keeping %u\n",size,TRACE_MAXSIZE);
+		size = TRACE_MAXSIZE;
+	}
+	while(n < size)
+		n <<= 1;
+	if(n > (size_t)-1 / sizeof(traceentry_t) || n > (size_t)-1 / sizeof(traceanchor_t)) {
+		log_printf("cpu_trace_start:  %u entries do not fit in memory\n",n);
+		return(1);
+	}
+
+	//the ppu moves at most once per instruction, so there are never more
+	//anchors to keep than instructions
+	TRACE.entries = (traceentry_t*)mem_alloc(n * sizeof(traceentry_t));
+	TRACE.anchors = (traceanchor_t*)mem_alloc(n * sizeof(traceanchor_t));
+	if(TRACE.entries == 0 || TRACE.anchors == 0) {
+		log_printf("cpu_trace_start:  unable to allocate %u entries\n",n);
+		cpu_trace_stop();
+		return(1);
+	}
+	TRACE.mask = n - 1;
+	TRACE.count = 0;
+	TRACE.anchorcount = 0;
+	log_printf("cpu_trace_start:  recording the last %u instructions\n",n);
+	return(0);
+}
+
+void cpu_trace_stop()
+{
+	if(TRACE.entries)
+		mem_free(TRACE.entries);
+	if(TRACE.anchors)
+		mem_free(TRACE.anchors);
+	TRACE.entries = 0;
+	TRACE.anchors = 0;
+	TRACE.mask = 0;
+	TRACE.count = 0;
+	TRACE.anchorcount = 0;
+}
+
+//remember where the ppu is.  the ppu is never caught up for the trace, its
+//position is only taken from the cpu cycle it was last run up to.
+void cpu_trace_anchor()
+{
+	traceanchor_t *a = &TRACE.anchors[(u32)TRACE.anchorcount++ & TRACE.mask];
+
+	TRACE.ppucycles = nes->scheduler.ppucycles;
+	a->cycle = (u32)nes->scheduler.ppucycles;
+	a->scanline = (u16)nes->ppu.scanline;
+	a->linecycle = (u16)nes->ppu.linecycles;
+	a->palticks = (u8)nes->scheduler.palticks;
+	a->oddframe = (u8)(nes->ppu.frames & 1);
+	a->rendering = (nes->ppu.control1 & 0x18) ? 1 : 0;
+}
+
+//work out the ppu position a number of cpu cycles after an anchor.  nothing
+//the cpu can change without the ppu being caught up (and a new anchor being
+//taken) happens in between, so this is the same stepping the ppu does.
+static void trace_position(traceanchor_t *a,u32 cycles,traceentry_t *e)
+{
+	u32 dots = cycles * 3;
+	u32 line = a->scanline;
+	u32 dot = a->linecycle;
+	u32 end = nes->region->end_line;
+	u32 odd = a->oddframe;
+	u32 left;
+	int skip;
+
+	if(nes->region->id == REGION_PAL)
+		dots += (a->palticks + cycles) / 5;
+	for(;;) {
+
+		//dot 339 of the last line is skipped on odd frames while rendering
+		skip = (line == end && odd && a->rendering && nes->region->id != REGION_PAL && dot <= 338);
+		left = (skip ? 340 : 341) - dot;
+		if(dots < left) {
+			dot += dots;
+			if(skip && dot > 338)
+				dot++;
+			break;
+		}
+		dots -= left;
+		dot = 0;
+		if(++line > end) {
+			line = 0;
+			odd ^= 1;
+		}
+	}
+	e->scanline = (u16)line;
+	e->linecycle = (u16)dot;
+}
+
+//fill in the ppu position of the entries, oldest first
+static void trace_positions(u32 start,u32 n)
+{
+	u32 size = TRACE.mask + 1;
+	u32 i,a,na,astart;
+	traceentry_t *e;
+	traceanchor_t *anchor;
+
+	na = (TRACE.anchorcount < size) ? (u32)TRACE.anchorcount : size;
+	astart = (u32)(TRACE.anchorcount - na) & TRACE.mask;
+	for(i=0,a=0;i<n;i++) {
+		e = &TRACE.entries[(start + i) & TRACE.mask];
+
+		//latest anchor at or before the instruction
+		while(a + 1 < na && (s32)(TRACE.anchors[(astart + a + 1) & TRACE.mask].cycle - e->cycle) <= 0)
+			a++;
+		anchor = &TRACE.anchors[(astart + a) & TRACE.mask];
+		if(na == 0 || (s32)(anchor->cycle - e->cycle) > 0) {
+			e->scanline = e->linecycle = 0xFFFF;
+			continue;
+		}
+		trace_position(anchor,e->cycle - anchor->cycle,e);
+	}
+}
+
+//pack an entry into the saved layout
+static void trace_pack(traceentry_t *e,u8 *data)
+{
+	data[0] = (u8)e->cycle;
+	data[1] = (u8)(e->cycle >> 8);
+	data[2] = (u8)(e->cycle >> 16);
+	data[3] = (u8)(e->cycle >> 24);
+	data[4] = (u8)e->pc;
+	data[5] = (u8)(e->pc >> 8);
+	data[6] = (u8)e->scanline;
+	data[7] = (u8)(e->scanline >> 8);
+	data[8] = (u8)e->linecycle;
+	data[9] = (u8)(e->linecycle >> 8);
+	data[10] = e->a;
+	data[11] = e->x;
+	data[12] = e->y;
+	data[13] = e->p;
+	data[14] = e->sp;
+	memcpy(data + 15,e->bytes,3);
+}
+
+//unpack an entry from the saved layout
+static void trace_unpack(u8 *data,traceentry_t *e)
+{
+	e->cycle = data[0] | (data[1] << 8) | (data[2] << 16) | ((u32)data[3] << 24);
+	e->pc = data[4] | (data[5] << 8);
+	e->scanline = data[6] | (data[7] << 8);
+	e->linecycle = data[8] | (data[9] << 8);
+	e->a = data[10];
+	e->x = data[11];
+	e->y = data[12];
+	e->p = data[13];
+	e->sp = data[14];
+	memcpy(e->bytes,data + 15,3);
+}
+
+//write the recorded instructions, oldest first
+int cpu_trace_save(char *filename)
+{
+	FILE *fp;
+	u32 size,n,start,i;
+	u8 data[TRACE_ENTRYSIZE];
+
+	if(TRACE.entries == 0) {
+		log_printf("cpu_trace_save:  trace is not running\n");
+		return(1);
+	}
+	if((fp = fopen(filename,"wb")) == 0) {
+		log_printf("cpu_trace_save:  error opening '%s'\n",filename);
+		return(1);
+	}
+	size = TRACE.mask + 1;
+	n = (TRACE.count < size) ? (u32)TRACE.count : size;
+	start = (u32)(TRACE.count - n) & TRACE.mask;
+	trace_positions(start,n);
+	data[0] = (u8)n;
+	data[1] = (u8)(n >> 8);
+	data[2] = (u8)(n >> 16);
+	data[3] = (u8)(n >> 24);
+	fwrite(TRACE_IDENT,1,4,fp);
+	fwrite(data,1,4,fp);
+	for(i=0;i<n;i++) {
+		trace_pack(&TRACE.entries[(start + i) & TRACE.mask],data);
+		fwrite(data,1,TRACE_ENTRYSIZE,fp);
+	}
+	fclose(fp);
+	log_printf("cpu_trace_save:  saved %u instructions to '%s'\n",n,filename);
+	return(0);
+}
+
+//render a saved trace as text
+int cpu_trace_decode(char *filename,char *textfile)
+{
+	FILE *fp,*out;
+	traceentry_t e;
+	char ident[4],buf[64];
+	u8 data[TRACE_ENTRYSIZE];
+	u32 i,n;
+
+	if((fp = fopen(filename,"rb")) == 0) {
+		log_printf("cpu_trace_decode:  error opening '%s'\n",filename);
+		return(1);
+	}
+	if(fread(ident,1,4,fp) != 4 || memcmp(ident,TRACE_IDENT,4) != 0 || fread(data,1,4,fp) != 4) {
+		log_printf("cpu_trace_decode:  '%s' is not a trace file\n",filename);
+		fclose(fp);
+		return(1);
+	}
+	n = data[0] | (data[1] << 8) | (data[2] << 16) | ((u32)data[3] << 24);
+	if((out = fopen(textfile,"wt")) == 0) {
+		log_printf("cpu_trace_decode:  error creating '%s'\n",textfile);
+		fclose(fp);
+		return(1);
+	}
+	for(i=0;i<n;i++) {
+		if(fread(data,1,TRACE_ENTRYSIZE,fp) != TRACE_ENTRYSIZE)
+			break;
+		trace_unpack(data,&e);
+		cpu_disassemble_bytes(buf,e.pc,e.bytes);
+		fprintf(out,"%10u %3d,%3d A:%02X X:%02X Y:%02X P:%02X SP:%02X  %04X: %s\n",
+			e.cycle,e.scanline,e.linecycle,e.a,e.x,e.y,e.p,e.sp,e.pc,buf);
+	}
+	fclose(out);
+	fclose(fp);
+	log_printf("cpu_trace_decode:  wrote %u instructions to '%s'\n",i,textfile);
+	return(0);
+}
@@ -0,0 +1,60 @@
+/***************************************************************************
+ *   Copyright (C) 2013 by James Holodnak                                  *
+ *   jamesholodnak@gmail.com                                               *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#ifndef __nes__cpu__trace_h__
+#define __nes__cpu__trace_h__
+
+#include "types.h"
+
+//one executed instruction, state before it runs
+typedef struct traceentry_s {
+	u32	cycle;				//low 32 bits of the cpu cycle counter
+	u16	pc;
+	u16	scanline,linecycle;	//ppu position, filled in when the trace is saved
+	u8		a,x,y,p,sp;
+	u8		bytes[3];			//opcode and operands
+} traceentry_t;
+
+//where the ppu was at a cpu cycle, recorded whenever it has moved
+typedef struct traceanchor_s {
+	u32	cycle;				//low 32 bits of the cpu cycle the ppu is at
+	u16	scanline,linecycle;
+	u8		palticks;			//pal cycle count towards the extra dot
+	u8		oddframe;
+	u8		rendering;			//rendering enabled (for the odd frame dot skip)
+} traceanchor_t;
+
+//ring buffers holding the last (mask + 1) instructions and ppu positions
+typedef struct trace_s {
+	traceentry_t	*entries;
+	traceanchor_t	*anchors;
+	u32				mask;
+	u64				count;		//instructions recorded since start
+	u64				anchorcount;
+	u64				ppucycles;	//cpu cycle of the last anchor
+} trace_t;
+
+int cpu_trace_start(u32 size);
+void cpu_trace_stop();
+void cpu_trace_anchor();
+int cpu_trace_save(char *filename);
+int cpu_trace_decode(char *filename,char *textfile);
+
+#endif
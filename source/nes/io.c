@@ -50,7 +50,7 @@ u8 nes_read_4000(u32 addr)
 			return(nes->inputdev[1]->read());
 
 		default:
-			if(config_get_bool("nes.log_unhandled_io"))
+			if(configcache.log_unhandled_io)
 				log_printf("nes_read_4000:  unhandled read at $%04X\n",addr);
 			break;
 	}
@@ -60,8 +60,6 @@ u8 nes_read_4000(u32 addr)
 //write to sprite dma, nes joypad strobe, and apu registers
 void nes_write_4000(u32 addr,u8 data)
 {
-	u32 temp,temp2;
-
 	switch(addr) {
 		//apu registers
 		case 0x4000:	case 0x4001:	case 0x4002:	case 0x4003:
@@ -75,12 +73,7 @@ void nes_write_4000(u32 addr,u8 data)
 
 		//sprite dma write
 		case 0x4014:
-			temp2 = data << 8;
-			for(temp=0;temp<256;temp++,temp2++)
-				cpu_write(0x2004,cpu_read(temp2));
-			temp2 = 513 + ((u32)nes->cpu.cycles & 1);
-			for(temp=0;temp<temp2;temp++)
-				cpu_tick();
+			cpu_oam_dma(data);
 			break;
 
 		//strobe joypads
@@ -91,7 +84,7 @@ void nes_write_4000(u32 addr,u8 data)
 			break;
 
 		default:
-			if(config_get_bool("nes.log_unhandled_io"))
+			if(configcache.log_unhandled_io)
 				log_printf("nes_write_4000:  unhandled write at $%04X = $%02X\n",addr,data);
 			break;
 	}
@@ -99,19 +92,19 @@ void nes_write_4000(u32 addr,u8 data)
 
 u8 nes_read_mem(u32 addr)
 {
-	if(nes->cpu.readpages[addr >> 10])
-		return(nes->cpu.readpages[addr >> 10][addr & 0x3FF]);
+	if(nes->cpu.pages[addr >> 10].readptr)
+		return(nes->cpu.pages[addr >> 10].readptr[addr & 0x3FF]);
 	return(0);
 }
 
 void nes_write_mem(u32 addr,u8 data)
 {
-	if(nes->cpu.writepages[addr >> 10])
-		nes->cpu.writepages[addr >> 10][addr & 0x3FF] = data;
+	if(nes->cpu.pages[addr >> 10].writeptr)
+		nes->cpu.pages[addr >> 10].writeptr[addr & 0x3FF] = data;
 }
 
 //read nes rom memory area ($8000-FFFF)
 u8 nes_read_rom(u32 addr)
 {
-	return(nes->cpu.readpages[addr >> 10][addr & 0x3FF]);
+	return(nes->cpu.pages[addr >> 10].readptr[addr & 0x3FF]);
 }
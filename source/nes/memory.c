@@ -25,61 +25,61 @@
 void mem_setreadfunc(int page,readfunc_t func)
 {
 	page <<= 2;
-	nes->cpu.readfuncs[page+0] = func;
-	nes->cpu.readfuncs[page+1] = func;
-	nes->cpu.readfuncs[page+2] = func;
-	nes->cpu.readfuncs[page+3] = func;
+	nes->cpu.pages[page+0].readfunc = func;
+	nes->cpu.pages[page+1].readfunc = func;
+	nes->cpu.pages[page+2].readfunc = func;
+	nes->cpu.pages[page+3].readfunc = func;
 }
 
 void mem_setwritefunc(int page,writefunc_t func)
 {
 	page <<= 2;
-	nes->cpu.writefuncs[page+0] = func;
-	nes->cpu.writefuncs[page+1] = func;
-	nes->cpu.writefuncs[page+2] = func;
-	nes->cpu.writefuncs[page+3] = func;
+	nes->cpu.pages[page+0].writefunc = func;
+	nes->cpu.pages[page+1].writefunc = func;
+	nes->cpu.pages[page+2].writefunc = func;
+	nes->cpu.pages[page+3].writefunc = func;
 }
 
 void mem_setreadptr(int page,u8 *ptr)
 {
 	page <<= 2;
-	nes->cpu.readpages[page+0] = ptr;
-	nes->cpu.readpages[page+1] = ptr + 0x400;
-	nes->cpu.readpages[page+2] = ptr + 0x800;
-	nes->cpu.readpages[page+3] = ptr + 0xC00;
+	nes->cpu.pages[page+0].readptr = ptr;
+	nes->cpu.pages[page+1].readptr = ptr + 0x400;
+	nes->cpu.pages[page+2].readptr = ptr + 0x800;
+	nes->cpu.pages[page+3].readptr = ptr + 0xC00;
 }
 
 void mem_setwriteptr(int page,u8 *ptr)
 {
 	page <<= 2;
-	nes->cpu.writepages[page+0] = ptr;
-	nes->cpu.writepages[page+1] = ptr + 0x400;
-	nes->cpu.writepages[page+2] = ptr + 0x800;
-	nes->cpu.writepages[page+3] = ptr + 0xC00;
+	nes->cpu.pages[page+0].writeptr = ptr;
+	nes->cpu.pages[page+1].writeptr = ptr + 0x400;
+	nes->cpu.pages[page+2].writeptr = ptr + 0x800;
+	nes->cpu.pages[page+3].writeptr = ptr + 0xC00;
 }
 
 readfunc_t mem_getreadfunc(int page)			
 {	
 	page <<= 2;
-	return(nes->cpu.readfuncs[page]);
+	return(nes->cpu.pages[page].readfunc);
 }
 
 writefunc_t mem_getwritefunc(int page)			
 {
 	page <<= 2;
-	return(nes->cpu.writefuncs[page]);
+	return(nes->cpu.pages[page].writefunc);
 }
 
 u8 *mem_getreadptr(int page)					
 {
 	page <<= 2;
-	return(nes->cpu.readpages[page]);	
+	return(nes->cpu.pages[page].readptr);	
 }
 
 u8 *mem_getwriteptr(int page)			
 {
 	page <<= 2;
-	return(nes->cpu.writepages[page]);
+	return(nes->cpu.pages[page].writeptr);
 }
 
 void mem_setppureadfunc(int page,readfunc_t func)		{	nes->ppu.readfuncs[page] = func;		}
@@ -97,8 +97,8 @@ void mem_unsetcpu(int banksize,int page)
 
 	page <<= 2;
 	for(i=0;i<(banksize);i++) {
-		nes->cpu.readpages[page + i] = 
-		nes->cpu.writepages[page + i] = 0;
+		nes->cpu.pages[page + i].readptr = 
+		nes->cpu.pages[page + i].writeptr = 0;
 	}
 }
 
@@ -121,8 +121,8 @@ void mem_setprg(int banksize,int page,int bank)
 
 	page <<= 2;
 	for(i=0;i<(banksize);i++) {
-		nes->cpu.readpages[page + i] = ptr + ((i * 0x400) & nes->cart->prg.mask);
-		nes->cpu.writepages[page + i] = 0;
+		nes->cpu.pages[page + i].readptr = ptr + ((i * 0x400) & nes->cart->prg.mask);
+		nes->cpu.pages[page + i].writeptr = 0;
 	}
 }
 
@@ -133,8 +133,8 @@ void mem_setwram(int banksize,int page,int bank)
 
 	page <<= 2;
 	for(i=0;i<(banksize);i++) {
-		nes->cpu.readpages[page + i] = 
-		nes->cpu.writepages[page + i] = ptr + i * 0x400;
+		nes->cpu.pages[page + i].readptr = 
+		nes->cpu.pages[page + i].writeptr = ptr + i * 0x400;
 	}
 }
 
@@ -149,16 +149,41 @@ void mem_setnt(int banksize,int page,int bank)
 	}
 }
 
+//convert a 1kb chr page to cached tiles if it hasnt been already
+static void cache_chrpage(int offset)
+{
+	cart_t *cart = nes->cart;
+	int n = offset / 0x400;
+	u32 size;
+
+	if(cart->cachevalid == 0 || (u32)offset >= cart->chr.size)
+		return;
+	if(cart->cachevalid[n / 8] & (1 << (n & 7)))
+		return;
+	cart->cachevalid[n / 8] |= 1 << (n & 7);
+
+	//chr smaller than a page only has that much to convert
+	size = cart->chr.size - offset;
+	if(size > 0x400)
+		size = 0x400;
+	cache_tiles_both(cart->chr.data + offset,(cache_t*)((u8*)cart->cache + offset),
+		cart->cache_hflip ? (cache_t*)((u8*)cart->cache_hflip + offset) : 0,size / 16);
+}
+
 void mem_setchr(int banksize,int page,int bank)
 {
 	int i,p,offset = (bank * banksize * 1024) & nes->cart->chr.mask;
 
 	for(i=0;i<banksize;i++) {
 		p = page + i;
+		cache_chrpage(offset + (i * 0x400));
 		nes->ppu.readpages[p] = nes->cart->chr.data + offset + (i * 1024);
 		nes->ppu.writepages[p] = 0;
 		nes->ppu.cachepages[p] = (cache_t*)((u8*)nes->cart->cache + offset + (i * 0x400));
-		nes->ppu.cachepages_hflip[p] = (cache_t*)((u8*)nes->cart->cache_hflip + offset + (i * 0x400));
+		if(nes->cart->cache_hflip)
+			nes->ppu.cachepages_hflip[p] = (cache_t*)((u8*)nes->cart->cache_hflip + offset + (i * 0x400));
+		else
+			nes->ppu.cachepages_hflip[p] = 0;
 	}
 }
 
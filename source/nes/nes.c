@@ -32,7 +32,7 @@
 #include "nes/state/state.h"
 #include "nes/cart/patch/patch.h"
 
-nes_t *nes = 0;
+THREADLOCAL nes_t *nes = 0;
 
 //kludge (or possibly not)
 static void mapper_state(int mode,u8 *data)	{	nes->mapper->state(mode,data);		}
@@ -42,10 +42,8 @@ static void wram_state(int mode,u8 *data)		{	STATE_ARRAY_U8(nes->cart->wram.data
 static void vram_state(int mode,u8 *data)
 {
 	STATE_ARRAY_U8(nes->cart->vram.data,nes->cart->vram.size);
-	if(mode == STATE_LOAD) {
-		cache_tiles(nes->cart->vram.data,nes->cart->vcache,nes->cart->vram.size / 16,0);
-		cache_tiles(nes->cart->vram.data,nes->cart->vcache_hflip,nes->cart->vram.size / 16,1);
-	}
+	if(mode == STATE_LOAD)
+		ppu_dirtytiles(0,nes->cart->vram.size);
 }
 
 static int get_device_id(char *str)
@@ -188,6 +186,7 @@ int nes_load_patched(char *filename,char *patchfilename)
 void nes_unload()
 {
 	movie_stop();
+	cpu_profile_stop();
 	//need to save sram/diskdata/whatever here
 	if(nes->cart)
 		cart_unload(nes->cart);
@@ -214,10 +213,10 @@ void nes_reset(int hard)
 
 	//zero out all read/write pages/functions
 	for(i=0;i<64;i++) {
-		nes->cpu.readfuncs[i] = 0;
-		nes->cpu.readpages[i] = 0;
-		nes->cpu.writefuncs[i] = 0;
-		nes->cpu.writepages[i] = 0;
+		nes->cpu.pages[i].readfunc = 0;
+		nes->cpu.pages[i].readptr = 0;
+		nes->cpu.pages[i].writefunc = 0;
+		nes->cpu.pages[i].writeptr = 0;
 		nes->ppu.readfuncs[i / 4] = 0;
 		nes->ppu.readpages[i / 4] = 0;
 		nes->ppu.writefuncs[i / 4] = 0;
@@ -254,9 +253,11 @@ void nes_reset(int hard)
 	//reset the mapper
 	nes->mapper->reset(hard);
 
-	//reset the cpu, ppu, and apu
+	//reset the cpu, ppu, and apu (catching up the vector fetch before the apu reset)
+	scheduler_reset();
 	ppu_reset(hard);
 	cpu_reset(hard);
+	scheduler_sync();
 	apu_reset(hard);
 
 	//clear some memory for hard reset
@@ -264,6 +265,7 @@ void nes_reset(int hard)
 		memset(nes->cpu.ram,0,0x800);
 		memset(nes->ppu.nametables,0,0x800);
 		memset(nes->ppu.oam,0,256);
+		nes->ppu.spriteheight = 0;
 		memset(nes->ppu.palette,0,32);
 	}
 }
@@ -276,6 +278,11 @@ void nes_frame()
 	if(nes->movie.mode)
 		movie_frame();
 	cpu_execute_frame();
+
+	//catch everything up for the end of the frame
+	scheduler_sync();
+	if(nes->cpu.profile.enabled)
+		cpu_profile_frame();
 }
 
 void nes_state(int mode,u8 *data)
@@ -24,7 +24,10 @@
 #include "types.h"
 #include "nes/movie.h"
 #include "nes/region.h"
+#include "nes/scheduler.h"
 #include "nes/cpu/cpu.h"
+#include "nes/cpu/trace.h"
+#include "nes/cpu/profile.h"
 #include "nes/ppu/ppu.h"
 #include "nes/apu/apu.h"
 #include "nes/cart/cart.h"
@@ -69,6 +72,9 @@ typedef struct nes_s {
 	apu_t			apu;
 	ppu_t			ppu;
 
+	//event scheduler
+	scheduler_t	scheduler;
+
 	//cartridge inserted
 	cart_t		*cart;
 
@@ -86,7 +92,10 @@ typedef struct nes_s {
 
 } nes_t;
 
-extern nes_t *nes;
+//the instance being emulated.  each thread has its own pointer, so a thread
+//runs its own instance after nes_init (or after pointing nes at one it owns).
+//the cpu core reaches all of its state through it.
+extern THREADLOCAL nes_t *nes;
 
 int nes_init();
 void nes_kill();
@@ -18,6 +18,7 @@
  *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
  ***************************************************************************/
 
+#include <string.h>
 #include "misc/log.h"
 #include "nes/nes.h"
 #include "system/video.h"
@@ -37,13 +38,105 @@ static u8 read_ppu_memory(u32 addr)
 		return(nes->ppu.readfuncs[addr >> 10](addr));
 
 	//spit out debug message
-	else if(config_get_bool("nes.log_unhandled_io"))
+	else if(configcache.log_unhandled_io)
 		log_printf("ppu_memread: read from unmapped memory at $%04X\n",addr);
 
 	//return open bus
 	return((u8)(addr >> 8));
 }
 
+//mark the vram tiles in offset..offset+len as needing to be cached again
+void ppu_dirtytiles(u32 offset,u32 len)
+{
+	u32 *dirty = nes->cart->vdirty;
+	u32 tile;
+
+	for(tile=offset/16;tile<(offset + len + 15)/16;tile++)
+		dirty[tile / 32] |= 1u << (tile & 31);
+	nes->ppu.cachedirty = 1;
+}
+
+//convert all dirty vram tiles, runs of dirty tiles are converted at once
+void ppu_flushtiles()
+{
+	cart_t *cart = nes->cart;
+	u32 *dirty,bits,tile;
+	u32 i,n,start;
+
+	nes->ppu.cachedirty = 0;
+	if(cart == 0 || cart->vdirty == 0)
+		return;
+	dirty = cart->vdirty;
+	for(i=0;i<cart->vram.size / 16 / 32;i++) {
+		if((bits = dirty[i]) == 0)
+			continue;
+		dirty[i] = 0;
+		for(n=0;n<32;) {
+			if((bits & (1u << n)) == 0) {
+				n++;
+				continue;
+			}
+			for(start=n;n<32 && (bits & (1u << n));n++);
+			tile = i * 32 + start;
+			cache_tiles_both(cart->vram.data + tile * 16,cart->vcache + tile * 2,cart->vcache_hflip + tile * 2,n - start);
+		}
+	}
+}
+
+//add (or remove) sprite n to the lines covered by a sprite at y
+static INLINE void setspritelines(int n,u32 y,int set)
+{
+	u64 bit = (u64)1 << n;
+	u32 end = y + nes->ppu.spriteheight;
+
+	if(end > 256)
+		end = 256;
+	for(;y<end;y++) {
+		if(set)
+			nes->ppu.spritelines[y] |= bit;
+		else
+			nes->ppu.spritelines[y] &= ~bit;
+	}
+}
+
+//rebuild the sprite lines for the current sprite height
+void ppu_buildspritelines()
+{
+	int i;
+
+	memset(nes->ppu.spritelines,0,sizeof(nes->ppu.spritelines));
+	nes->ppu.spriteheight = 8 + ((CONTROL0 & 0x20) >> 2);
+	for(i=0;i<64;i++)
+		setspritelines(i,nes->ppu.oam[i * 4],1);
+}
+
+//write a byte to oam ($2004)
+static INLINE void oam_write(u8 data)
+{
+	//check if we are rendering
+	if(nes->ppu.rendering)
+		data = 0xFF;
+
+	//move the sprite if its y coordinate changed
+	if((nes->ppu.oamaddr & 3) == 0 && nes->ppu.spriteheight && nes->ppu.oam[nes->ppu.oamaddr] != data) {
+		setspritelines(nes->ppu.oamaddr >> 2,nes->ppu.oam[nes->ppu.oamaddr],0);
+		setspritelines(nes->ppu.oamaddr >> 2,data,1);
+	}
+	nes->ppu.oam[nes->ppu.oamaddr++] = data;
+}
+
+//copy a page to oam, the same as writing it to $2004 a byte at a time
+void ppu_oamwrite(u8 *data)
+{
+	int i;
+
+	//the sprite lines are rebuilt once instead of moving each sprite
+	nes->ppu.spriteheight = 0;
+	for(i=0;i<256;i++)
+		oam_write(data[i]);
+	nes->ppu.buf = data[255];
+}
+
 static void write_ppu_memory(u32 addr,u8 data)
 {
 	u8 page = (addr >> 10) & 0xF;
@@ -53,15 +146,20 @@ static void write_ppu_memory(u32 addr,u8 data)
 	if(nes->ppu.writepages[page]) {
 		nes->ppu.writepages[page][addr & 0x3FF] = data;
 
-		//we have tile cache for this page, update it
+		//we have tile cache for this page.  vram tiles are only marked here
+		//and converted once when the ppu next fetches tile data.
 		cache = nes->ppu.cachepages[page];
 		if(cache) {
 			u8 *chr = nes->ppu.readpages[page];
 			u32 a = addr & 0x3F0;
+			cart_t *cart = nes->cart;
 
-			cache_hflip = nes->ppu.cachepages_hflip[page];
-			cache_tile(chr + a,cache + (a / 8));
-			cache_tile_hflip(chr + a,cache_hflip + (a / 8));
+			if(cart->vdirty && chr >= cart->vram.data && chr < cart->vram.data + cart->vram.size)
+				ppu_dirtytiles((u32)(chr + a - cart->vram.data),16);
+			else {
+				cache_hflip = nes->ppu.cachepages_hflip[page];
+				cache_tiles_both(chr + a,cache + (a / 8),cache_hflip ? cache_hflip + (a / 8) : 0,1);
+			}
 		}
 	}
 
@@ -70,7 +168,7 @@ static void write_ppu_memory(u32 addr,u8 data)
 		nes->ppu.writefuncs[page](addr,data);
 
 	//not mapped, report error
-	else if(config_get_bool("nes.log_unhandled_io"))
+	else if(configcache.log_unhandled_io)
 		log_printf("ppu_memwrite: write to unmapped memory at $%04X = $%02X\n",addr,data);
 }
 
@@ -94,14 +192,47 @@ void ppu_setwritefunc(writefunc_t writefunc)
 	ppu_memwrite = (writefunc == 0) ? write_ppu_memory : writefunc;
 }
 
+//see if rendering fetches can be done without side effects (no read hook and
+//pattern/nametable pages all mapped to memory)
+int ppu_plainreads()
+{
+	int i;
+
+	if(ppu_memread != read_ppu_memory)
+		return(0);
+	for(i=0;i<12;i++) {
+		if(nes->ppu.readpages[i] == 0)
+			return(0);
+	}
+	return(1);
+}
+
 u8 ppu_pal_read(u32 addr)
 {
 	return(nes->ppu.palette[addr]);
 }
 
+//number of screen pixels already drawn this frame.  with rendering enabled
+//dot n draws pixel n-1, otherwise dot n draws pixel n.
+static int drawn_pixels()
+{
+	u32 x = LINECYCLES;
+
+	if(SCANLINE >= 240)
+		return(256 * 240);
+	if((CONTROL1 & 0x18) && x > 0)
+		x--;
+	if(x > 256)
+		x = 256;
+	return((SCANLINE * 256) + x);
+}
+
 void ppu_pal_write(u32 addr,u8 data)
 {
 	nes->ppu.palette[addr] = data;
+
+	//pixels already drawn keep the color they were drawn with
+	video_updatescreen(drawn_pixels());
 	video_updatepalette(addr,data);
 }
 
@@ -212,10 +343,7 @@ void ppu_write(u32 addr,u8 data)
 			nes->ppu.oamaddr = data;
 			return;
 		case 4:
-			//check if we are rendering
-			if(nes->ppu.rendering)
-				data = 0xFF;
-			nes->ppu.oam[nes->ppu.oamaddr++] = data;
+			oam_write(data);
 			return;
 		case 5:				//scroll
 			if(TOGGLE == 0) { //first write
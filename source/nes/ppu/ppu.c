@@ -21,15 +21,19 @@
 #include "nes/nes.h"
 #include "nes/memory.h"
 #include "nes/state/state.h"
+#include "system/video.h"
 
 int ppu_init()
 {
 	state_register(B_PPU,ppu_state);
+	video_setscreen(nes->ppu.screen);
+	ppu_composite_init();
 	return(0);
 }
 
 void ppu_kill()
 {
+	video_setscreen(0);
 }
 
 void ppu_reset(int hard)
@@ -42,6 +46,8 @@ void ppu_reset(int hard)
 	nes->ppu.iodata = 0;
 	nes->ppu.iomode = 0;
 	nes->ppu.rendering = 0;
+	nes->ppu.skipframe = 0;
+	nes->ppu.skipcount = 0;
 }
 
 void ppu_sync()
@@ -75,5 +81,7 @@ void ppu_state(int mode,u8 *data)
 	STATE_U8(nes->ppu.iomode);
 	STATE_ARRAY_U8(nes->ppu.nametables,0x1000);
 	STATE_ARRAY_U8(nes->ppu.palette,32);
+	if(mode == STATE_LOAD)
+		nes->ppu.spriteheight = 0;
 	ppu_sync();
 }
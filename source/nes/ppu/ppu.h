@@ -24,6 +24,15 @@
 #include "types.h"
 #include "tilecache.h"
 
+typedef struct {
+	u64 line;				//cache line data
+	u8 attr;					//attrib bits
+	u8 x;						//x coord
+	u8 flags;				//flags
+	u8 tile;					//sprite tile index
+	u8 sprline;				//line of sprite bitmap to draw
+} sprtemp_t;				//sprite temp entry
+
 typedef struct ppu_s {
 
 	//registers
@@ -54,6 +63,15 @@ typedef struct ppu_s {
 	u8		oam2read;
 	u8		oam2mode;
 
+	//sprites found for the next line, spr0 points at sprite 0 if it is one
+	sprtemp_t	sprtemp[8];
+	sprtemp_t	*spr0;
+
+	//sprites covering each line (bit n is sprite n), kept up to date by oam
+	//writes.  height is the sprite height the lines are for, 0 to rebuild.
+	u64	spritelines[256];
+	u8		spriteheight;
+
 	//ppu external io
 	u32	ioaddr;
 	u8		iodata,iomode;
@@ -88,11 +106,25 @@ typedef struct ppu_s {
 	cache_t	*cachepages[16];
 	cache_t	*cachepages_hflip[16];
 
+	//set when vram tiles were written and their cache is out of date
+	u8		cachedirty;
+
 	//line cycle counter, scanline counter and frame counter
 	u32	linecycles;
 	u32	scanline;
 	u32	frames;
 
+	//frame skipping, set when no pixels are output for this frame
+	u8		skipframe;
+	u32	skipcount;
+
+	//draw every line dot by dot (ppubench times the dot renderer with it)
+	u8		dotsonly;
+
+	//the screen (palette indexes with emphasis bits), converted by the video
+	//system at the end of each frame
+	u8		screen[256 * 240];
+
 } ppu_t;
 
 extern readfunc_t ppu_memread;
@@ -103,14 +135,24 @@ void ppu_kill();
 void ppu_reset(int hard);
 u8 ppu_read(u32 addr);
 void ppu_write(u32 addr,u8 data);
+void ppu_oamwrite(u8 *data);
 u8 ppu_pal_read(u32 addr);
 void ppu_pal_write(u32 addr,u8 data);
-void ppu_step();
+void ppu_run_ntsc(u32 dots);
+void ppu_run_pal(u32 dots);
+void ppu_run_dendy(u32 dots);
+int ppu_bench(u32 frames,int lines);
+void ppu_composite_init();
+u32 ppu_nextevent();
 void ppu_sync();
 void ppu_state(int mode,u8 *data);
 readfunc_t ppu_getreadfunc();
 writefunc_t ppu_getwritefunc();
 void ppu_setreadfunc(readfunc_t readfunc);
 void ppu_setwritefunc(writefunc_t writefunc);
+int ppu_plainreads();
+void ppu_dirtytiles(u32 offset,u32 len);
+void ppu_flushtiles();
+void ppu_buildspritelines();
 
 #endif
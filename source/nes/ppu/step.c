@@ -18,276 +18,149 @@
  *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
  ***************************************************************************/
 
+#include <string.h>
 #include "nes/nes.h"
-#include "system/video.h"
 #include "misc/log.h"
-
-typedef struct {
-	u64 line;				//cache line data
-	u8 attr;					//attrib bits
-	u8 x;						//x coord
-	u8 flags;				//flags
-	u8 tile;					//sprite tile index
-	u8 sprline;				//line of sprite bitmap to draw
-} sprtemp_t;				//sprite temp entry
-
-//todo: this needs to be moved to the ppu struct
-static sprtemp_t sprtemp[8];
-static sprtemp_t *spr0 = 0;
+#include "misc/memutil.h"
+#include "misc/config.h"
 
 #include "step/calc.c"
 #include "step/fetch.c"
 #include "step/scroll.c"
 #include "step/misc.c"
 #include "step/sprite.c"
+#include "step/composite.c"
 #include "step/draw.c"
 
-static INLINE void scanline_prerender()
+//the sprite line drawn at the end of each visible line is only used to draw
+//the next one.  line 239's is kept since line 0 of the next frame uses it.
+static INLINE int sprite_line_needed()
 {
-	/* There are 2 conditions that update all 5 PPU scroll counters with the
-	contents of the latches adjacent to them. The first is after a write to
-	2006/2. The second, is at the beginning of scanline 20, when the PPU starts
-	rendering data for the first time in a frame (this update won't happen if
-	all rendering is disabled via 2001.3 and 2001.4). */
-	switch(LINECYCLES) {
-
-		//the idle cycle
-		case 0:
-			nes->ppu.rendering = 1;
-			clear_sp0hit_flag();
-			break;
-
-		//nametable byte read
-		case 1:
-			//clear ppu status register
-			clear_nmi_flag();
-		case 9:		case 17:		case 25:		case 33:		case 41:		case 49:		case 57:
-		case 65:		case 73:		case 81:		case 89:		case 97:		case 105:	case 113:	case 121:
-		case 129:	case 137:	case 145:	case 153:	case 161:	case 169:	case 177:	case 185:
-		case 193:	case 201:	case 209:	case 217:	case 225:	case 233:	case 241:	case 249:
-			calc_ntaddr();
-			break;
-		case 2:		case 10:		case 18:		case 26:		case 34:		case 42:		case 50:		case 58:
-		case 66:		case 74:		case 82:		case 90:		case 98:		case 106:	case 114:	case 122:
-		case 130:	case 138:	case 146:	case 154:	case 162:	case 170:	case 178:	case 186:
-		case 194:	case 202:	case 210:	case 218:	case 226:	case 234:	case 242:	case 250:
-			fetch_ntbyte();
-			break;
-
-		//attribute table byte calc
-		case 3:
-			clear_nmi_line();
-		case 11:		case 19:		case 27:		case 35:		case 43:		case 51:		case 59:
-		case 67:		case 75:		case 83:		case 91:		case 99:		case 107:	case 115:	case 123:
-		case 131:	case 139:	case 147:	case 155:	case 163:	case 171:	case 179:	case 187:
-		case 195:	case 203:	case 211:	case 219:	case 227:	case 235:	case 243:	case 251:
-			calc_ataddr();
-			break;
+	return(nes->ppu.skipframe == 0 || SCANLINE == 239);
+}
 
-		//attribute table byte fetch
-		case 4:		fetch_atbyte(2);		break;
-		case 12:		fetch_atbyte(3);		break;
-		case 20:		fetch_atbyte(4);		break;
-		case 28:		fetch_atbyte(5);		break;
-		case 36:		fetch_atbyte(6);		break;
-		case 44:		fetch_atbyte(7);		break;
-		case 52:		fetch_atbyte(8);		break;
-		case 60:		fetch_atbyte(9);		break;
-		case 68:		fetch_atbyte(10);		break;
-		case 76:		fetch_atbyte(11);		break;
-		case 84:		fetch_atbyte(12);		break;
-		case 92:		fetch_atbyte(13);		break;
-		case 100:	fetch_atbyte(14);		break;
-		case 108:	fetch_atbyte(15);		break;
-		case 116:	fetch_atbyte(16);		break;
-		case 124:	fetch_atbyte(17);		break;
-		case 132:	fetch_atbyte(18);		break;
-		case 140:	fetch_atbyte(19);		break;
-		case 148:	fetch_atbyte(20);		break;
-		case 156:	fetch_atbyte(21);		break;
-		case 164:	fetch_atbyte(22);		break;
-		case 172:	fetch_atbyte(23);		break;
-		case 180:	fetch_atbyte(24);		break;
-		case 188:	fetch_atbyte(25);		break;
-		case 196:	fetch_atbyte(26);		break;
-		case 204:	fetch_atbyte(27);		break;
-		case 212:	fetch_atbyte(28);		break;
-		case 220:	fetch_atbyte(29);		break;
-		case 228:	fetch_atbyte(30);		break;
-		case 236:	fetch_atbyte(31);		break;
-		case 244:	fetch_atbyte(32);		break;
-		case 252:	fetch_atbyte(33);		break;
-
-		//pattern table byte 0 calc
-		case 5:		case 13:		case 21:		case 29:		case 37:		case 45:		case 53:		case 61:
-		case 69:		case 77:		case 85:		case 93:		case 101:	case 109:	case 117:	case 125:
-		case 133:	case 141:	case 149:	case 157:	case 165:	case 173:	case 181:	case 189:
-		case 197:	case 205:	case 213:	case 221:	case 229:	case 237:	case 245:	case 253:
-			calc_pt0addr();
-			break;
+//actions for the irregular dots at the end of a rendering scanline
+enum {
+	H_NONE = 0,		//idle or garbage fetch
+	H_SPRITES,		//evaluate sprites for the next line, reset horizontal scroll
+	H_NTADDR,		//nametable address
+	H_NTBYTE,		//nametable fetch
+	H_ATADDR,		//attribute address
+	H_SPT0ADDR,		//sprite pattern low address
+	H_SPT0,			//sprite pattern low fetch
+	H_SPT1ADDR,		//sprite pattern high address
+	H_SPT1,			//sprite pattern high fetch
+	H_TILE			//background tile fetch for the next line
+};
+
+//dots 257-340
+static const u8 hblank_actions[341 - 257] = {
+	//sprite fetches (garbage nametable/attribute fetches first)
+	H_SPRITES,	H_NONE,	H_ATADDR,	H_NONE,	H_SPT0ADDR,	H_SPT0,	H_SPT1ADDR,	H_SPT1,
+	H_NTADDR,	H_NONE,	H_ATADDR,	H_NONE,	H_SPT0ADDR,	H_SPT0,	H_SPT1ADDR,	H_SPT1,
+	H_NTADDR,	H_NONE,	H_ATADDR,	H_NONE,	H_SPT0ADDR,	H_SPT0,	H_SPT1ADDR,	H_SPT1,
+	H_NTADDR,	H_NONE,	H_ATADDR,	H_NONE,	H_SPT0ADDR,	H_SPT0,	H_SPT1ADDR,	H_SPT1,
+	H_NTADDR,	H_NONE,	H_ATADDR,	H_NONE,	H_SPT0ADDR,	H_SPT0,	H_SPT1ADDR,	H_SPT1,
+	H_NTADDR,	H_NONE,	H_ATADDR,	H_NONE,	H_SPT0ADDR,	H_SPT0,	H_SPT1ADDR,	H_SPT1,
+	H_NTADDR,	H_NONE,	H_ATADDR,	H_NONE,	H_SPT0ADDR,	H_SPT0,	H_SPT1ADDR,	H_SPT1,
+	H_NTADDR,	H_NONE,	H_ATADDR,	H_NONE,	H_SPT0ADDR,	H_SPT0,	H_SPT1ADDR,	H_SPT1,
+
+	//first two tiles for the next line
+	H_TILE,		H_TILE,	H_TILE,		H_TILE,	H_TILE,		H_TILE,	H_TILE,		H_TILE,
+	H_TILE,		H_TILE,	H_TILE,		H_TILE,	H_TILE,		H_TILE,	H_TILE,		H_TILE,
+
+	//garbage nametable fetches
+	H_NTADDR,	H_NTBYTE,	H_NONE,	H_NTBYTE
+};
+
+//fetch one background tile into the tile buffer (eight dots worth of fetches)
+static INLINE void fetch_tile(int tilenum)
+{
+	calc_ntaddr();
+	fetch_ntbyte();
+	calc_ataddr();
+	fetch_atbyte(tilenum);
+	calc_pt0addr();
+	fetch_pt0byte(tilenum);
+	calc_pt1addr();
+	fetch_pt1byte();
+	inc_hscroll();
+}
 
-		//pattern table byte 0 fetch
-		case 6:		fetch_pt0byte(2);		break;
-		case 14:		fetch_pt0byte(3);		break;
-		case 22:		fetch_pt0byte(4);		break;
-		case 30:		fetch_pt0byte(5);		break;
-		case 38:		fetch_pt0byte(6);		break;
-		case 46:		fetch_pt0byte(7);		break;
-		case 54:		fetch_pt0byte(8);		break;
-		case 62:		fetch_pt0byte(9);		break;
-		case 70:		fetch_pt0byte(10);	break;
-		case 78:		fetch_pt0byte(11);	break;
-		case 86:		fetch_pt0byte(12);	break;
-		case 94:		fetch_pt0byte(13);	break;
-		case 102:	fetch_pt0byte(14);	break;
-		case 110:	fetch_pt0byte(15);	break;
-		case 118:	fetch_pt0byte(16);	break;
-		case 126:	fetch_pt0byte(17);	break;
-		case 134:	fetch_pt0byte(18);	break;
-		case 142:	fetch_pt0byte(19);	break;
-		case 150:	fetch_pt0byte(20);	break;
-		case 158:	fetch_pt0byte(21);	break;
-		case 166:	fetch_pt0byte(22);	break;
-		case 174:	fetch_pt0byte(23);	break;
-		case 182:	fetch_pt0byte(24);	break;
-		case 190:	fetch_pt0byte(25);	break;
-		case 198:	fetch_pt0byte(26);	break;
-		case 206:	fetch_pt0byte(27);	break;
-		case 214:	fetch_pt0byte(28);	break;
-		case 222:	fetch_pt0byte(29);	break;
-		case 230:	fetch_pt0byte(30);	break;
-		case 238:	fetch_pt0byte(31);	break;
-		case 246:	fetch_pt0byte(32);	break;
-		case 254:	fetch_pt0byte(33);	break;
-
-		//pattern table byte 1 read
-		case 7:		case 15:		case 23:		case 31:		case 39:		case 47:		case 55:		case 63:
-		case 71:		case 79:		case 87:		case 95:		case 103:	case 111:	case 119:	case 127:
-		case 135:	case 143:	case 151:	case 159:	case 167:	case 175:	case 183:	case 191:
-		case 199:	case 207:	case 215:	case 223:	case 231:	case 239:	case 247:	case 255:
-			calc_pt1addr();
-			break;
-		case 8:		case 16:		case 24:		case 32:		case 40:		case 48:		case 56:		case 64:
-		case 72:		case 80:		case 88:		case 96:		case 104:	case 112:	case 120:	case 128:
-		case 136:	case 144:	case 152:	case 160:	case 168:	case 176:	case 184:	case 192:
-		case 200:	case 208:	case 216:	case 224:	case 232:	case 240:	case 248://	case 256:
-			fetch_pt1byte();
-			inc_hscroll();
-			break;
-		case 256:
+//one dot of the eight dot background tile fetch
+static INLINE void fetch_tile_dot(u32 dot,int tilenum)
+{
+	switch(dot) {
+		case 0:	calc_ntaddr();				break;
+		case 1:	fetch_ntbyte();			break;
+		case 2:	calc_ataddr();				break;
+		case 3:	fetch_atbyte(tilenum);	break;
+		case 4:	calc_pt0addr();			break;
+		case 5:	fetch_pt0byte(tilenum);	break;
+		case 6:	calc_pt1addr();			break;
+		case 7:
 			fetch_pt1byte();
 			inc_hscroll();
-			inc_vscroll();
 			break;
+	}
+}
 
-		//garbage nametable address calc
-		case 257:
+//one of dots 257-340 on a rendering scanline
+static INLINE void fetch_hblank_dot(u32 dot)
+{
+	switch(hblank_actions[dot - 257]) {
+		case H_SPRITES:
 #ifdef QUICK_SPRITES
 			quick_process_sprites();
 #endif
 			update_hscroll();
-		case 265:	case 273:	case 281:	case 289:	case 297:	case 305:	case 313:
 			calc_ntaddr();
 			break;
+		case H_NTADDR:		calc_ntaddr();		break;
+		case H_NTBYTE:		fetch_ntbyte();	break;
+		case H_ATADDR:		calc_ataddr();		break;
+		case H_SPT0ADDR:	calc_spt0addr();	break;
+		case H_SPT0:		fetch_spt0byte();	break;
+		case H_SPT1ADDR:	calc_spt1addr();	break;
+		case H_SPT1:		fetch_spt1byte();	break;
+		case H_TILE:		fetch_tile_dot((dot - 321) & 7,(dot - 321) >> 3);	break;
+	}
+}
 
-		//garbage nametable fetch
-		case 258:	case 266:	case 274:	case 282:	case 290:	case 298:	case 306:	case 314:
-			break;
-
-		//garbage attribute address calc
-		case 259:	case 267:	case 275:	case 283:	case 291:	case 299:	case 307:	case 315:
-			calc_ataddr();
-			break;
-
-		//garbage attribute fetch
-		case 260:	case 268:	case 276:	case 284:	case 292:	case 300:	case 308:	case 316:
-			break;
+static INLINE void scanline_prerender()
+{
+	u32 dot = LINECYCLES;
 
-		//calculate address of sprite pattern low
-		case 261:	case 269:	case 277:	case 285:	case 293:	case 301:	case 309:	case 317:
-			calc_spt0addr();
-			break;
+	/* There are 2 conditions that update all 5 PPU scroll counters with the
+	contents of the latches adjacent to them. The first is after a write to
+	2006/2. The second, is at the beginning of scanline 20, when the PPU starts
+	rendering data for the first time in a frame (this update won't happen if
+	all rendering is disabled via 2001.3 and 2001.4). */
 
-		//fetch sprite pattern low
-		case 262:	case 270:	case 278:	case 286:	case 294:	case 302:	case 310:	case 318:
-			fetch_spt0byte();
-			break;
+	//the idle cycle
+	if(dot == 0) {
+		nes->ppu.rendering = 1;
+		clear_sp0hit_flag();
+	}
 
-		//calculate address of sprite pattern high
-		case 263:	case 271:	case 279:	case 287:	case 295:	case 303:	case 311:	case 319:
-			calc_spt1addr();
-			break;
+	//background fetches, nothing drawn
+	else if(dot <= 256) {
+		if(dot == 1)
+			clear_nmi_flag();
+		else if(dot == 3)
+			clear_nmi_line();
+		fetch_tile_dot((dot - 1) & 7,((dot - 1) >> 3) + 2);
+		if(dot == 256)
+			inc_vscroll();
+	}
 
-		//fetch sprite pattern high (update scroll registers on cycle 304)
-		case 304:
+	//sprite fetches and the first tiles of the next line
+	else {
+		fetch_hblank_dot(dot);
+		if(dot == 304)
 			update_vscroll();
-		case 264:
-		case 272:
-		case 280:
-		case 288:
-		case 296:
-		case 312:
-			fetch_spt1byte();
-			break;
-		case 320:
-			fetch_spt1byte();
-//			nes->ppu.oamaddr = 0;
-			break;
-
-		//nametable byte for next scanline
-		case 321:	case 329:
-			calc_ntaddr();
-			break;
-		case 322:	case 330:
-			fetch_ntbyte();
-			break;
-
-		//attribute byte for next scanline
-		case 323:	case 331:
-			calc_ataddr();
-			break;
-		case 324:
-			fetch_atbyte(0);
-			break;
-		case 332:
-			fetch_atbyte(1);
-			break;
-
-		//pattern low byte tile
-		case 325:
-		case 333:
-			calc_pt0addr();
-			break;
-		case 326:
-			fetch_pt0byte(0);
-			break;
-		case 334:
-			fetch_pt0byte(1);
-			break;
-
-		//pattern high byte tile
-		case 327:	case 335:
-			calc_pt1addr();
-			break;
-		case 328:	case 336:
-			fetch_pt1byte();
-			inc_hscroll();
-			break;
-
-		//garbage nametable fetches
-		case 337:
-			calc_ntaddr();
-			break;
-		case 338:
-			fetch_ntbyte();
+		else if(dot == 338)
 			skip_cycle();
-			break;
-		case 339:
-//			calc_ntaddr();
-			break;
-		case 340:
-			fetch_ntbyte();
-			break;
 	}
 #ifndef QUICK_SPRITES
 	if(CONTROL1 & 0x10)
@@ -321,239 +194,26 @@ static INLINE void scanline_prerender_norender()
 //scanlines 0-239
 static INLINE void scanline_visible()
 {
-	switch(LINECYCLES) {
-		//the idle cycle
-		case 0:
-			break;
-
-		//nametable byte read
-		case 1:		case 9:		case 17:		case 25:		case 33:		case 41:		case 49:		case 57:
-		case 65:		case 73:		case 81:		case 89:		case 97:		case 105:	case 113:	case 121:
-		case 129:	case 137:	case 145:	case 153:	case 161:	case 169:	case 177:	case 185:
-		case 193:	case 201:	case 209:	case 217:	case 225:	case 233:	case 241:	case 249:
-			calc_ntaddr();
-			drawpixel();
-			break;
-		case 2:		case 10:		case 18:		case 26:		case 34:		case 42:		case 50:		case 58:
-		case 66:		case 74:		case 82:		case 90:		case 98:		case 106:	case 114:	case 122:
-		case 130:	case 138:	case 146:	case 154:	case 162:	case 170:	case 178:	case 186:
-		case 194:	case 202:	case 210:	case 218:	case 226:	case 234:	case 242:	case 250:
-			fetch_ntbyte();
-			drawpixel();
-			break;
+	u32 dot = LINECYCLES;
 
-		//attribute table byte read
-		case 3:		case 11:		case 19:		case 27:		case 35:		case 43:		case 51:		case 59:
-		case 67:		case 75:		case 83:		case 91:		case 99:		case 107:	case 115:	case 123:
-		case 131:	case 139:	case 147:	case 155:	case 163:	case 171:	case 179:	case 187:
-		case 195:	case 203:	case 211:	case 219:	case 227:	case 235:	case 243:	case 251:
-			calc_ataddr();
-			drawpixel();
-			break;
-
-		//attribute table byte fetch
-		case 4:		fetch_atbyte(2);		drawpixel();	break;
-		case 12:		fetch_atbyte(3);		drawpixel();	break;
-		case 20:		fetch_atbyte(4);		drawpixel();	break;
-		case 28:		fetch_atbyte(5);		drawpixel();	break;
-		case 36:		fetch_atbyte(6);		drawpixel();	break;
-		case 44:		fetch_atbyte(7);		drawpixel();	break;
-		case 52:		fetch_atbyte(8);		drawpixel();	break;
-		case 60:		fetch_atbyte(9);		drawpixel();	break;
-		case 68:		fetch_atbyte(10);		drawpixel();	break;
-		case 76:		fetch_atbyte(11);		drawpixel();	break;
-		case 84:		fetch_atbyte(12);		drawpixel();	break;
-		case 92:		fetch_atbyte(13);		drawpixel();	break;
-		case 100:	fetch_atbyte(14);		drawpixel();	break;
-		case 108:	fetch_atbyte(15);		drawpixel();	break;
-		case 116:	fetch_atbyte(16);		drawpixel();	break;
-		case 124:	fetch_atbyte(17);		drawpixel();	break;
-		case 132:	fetch_atbyte(18);		drawpixel();	break;
-		case 140:	fetch_atbyte(19);		drawpixel();	break;
-		case 148:	fetch_atbyte(20);		drawpixel();	break;
-		case 156:	fetch_atbyte(21);		drawpixel();	break;
-		case 164:	fetch_atbyte(22);		drawpixel();	break;
-		case 172:	fetch_atbyte(23);		drawpixel();	break;
-		case 180:	fetch_atbyte(24);		drawpixel();	break;
-		case 188:	fetch_atbyte(25);		drawpixel();	break;
-		case 196:	fetch_atbyte(26);		drawpixel();	break;
-		case 204:	fetch_atbyte(27);		drawpixel();	break;
-		case 212:	fetch_atbyte(28);		drawpixel();	break;
-		case 220:	fetch_atbyte(29);		drawpixel();	break;
-		case 228:	fetch_atbyte(30);		drawpixel();	break;
-		case 236:	fetch_atbyte(31);		drawpixel();	break;
-		case 244:	fetch_atbyte(32);		drawpixel();	break;
-		case 252:	fetch_atbyte(33);		drawpixel();	break;
-
-		//pattern table byte 0 calc
-		case 5:		case 13:		case 21:		case 29:		case 37:		case 45:		case 53:		case 61:
-		case 69:		case 77:		case 85:		case 93:		case 101:	case 109:	case 117:	case 125:
-		case 133:	case 141:	case 149:	case 157:	case 165:	case 173:	case 181:	case 189:
-		case 197:	case 205:	case 213:	case 221:	case 229:	case 237:	case 245:	case 253:
-			calc_pt0addr();
-			drawpixel();
-			break;
-
-		//pattern table byte 0 fetch
-		case 6:		fetch_pt0byte(2);		drawpixel();	break;
-		case 14:		fetch_pt0byte(3);		drawpixel();	break;
-		case 22:		fetch_pt0byte(4);		drawpixel();	break;
-		case 30:		fetch_pt0byte(5);		drawpixel();	break;
-		case 38:		fetch_pt0byte(6);		drawpixel();	break;
-		case 46:		fetch_pt0byte(7);		drawpixel();	break;
-		case 54:		fetch_pt0byte(8);		drawpixel();	break;
-		case 62:		fetch_pt0byte(9);		drawpixel();	break;
-		case 70:		fetch_pt0byte(10);	drawpixel();	break;
-		case 78:		fetch_pt0byte(11);	drawpixel();	break;
-		case 86:		fetch_pt0byte(12);	drawpixel();	break;
-		case 94:		fetch_pt0byte(13);	drawpixel();	break;
-		case 102:	fetch_pt0byte(14);	drawpixel();	break;
-		case 110:	fetch_pt0byte(15);	drawpixel();	break;
-		case 118:	fetch_pt0byte(16);	drawpixel();	break;
-		case 126:	fetch_pt0byte(17);	drawpixel();	break;
-		case 134:	fetch_pt0byte(18);	drawpixel();	break;
-		case 142:	fetch_pt0byte(19);	drawpixel();	break;
-		case 150:	fetch_pt0byte(20);	drawpixel();	break;
-		case 158:	fetch_pt0byte(21);	drawpixel();	break;
-		case 166:	fetch_pt0byte(22);	drawpixel();	break;
-		case 174:	fetch_pt0byte(23);	drawpixel();	break;
-		case 182:	fetch_pt0byte(24);	drawpixel();	break;
-		case 190:	fetch_pt0byte(25);	drawpixel();	break;
-		case 198:	fetch_pt0byte(26);	drawpixel();	break;
-		case 206:	fetch_pt0byte(27);	drawpixel();	break;
-		case 214:	fetch_pt0byte(28);	drawpixel();	break;
-		case 222:	fetch_pt0byte(29);	drawpixel();	break;
-		case 230:	fetch_pt0byte(30);	drawpixel();	break;
-		case 238:	fetch_pt0byte(31);	drawpixel();	break;
-		case 246:	fetch_pt0byte(32);	drawpixel();	break;
-		case 254:	fetch_pt0byte(33);	drawpixel();	break;
-
-		//pattern table byte 1 read
-		case 7:		case 15:		case 23:		case 31:		case 39:		case 47:		case 55:		case 63:
-		case 71:		case 79:		case 87:		case 95:		case 103:	case 111:	case 119:	case 127:
-		case 135:	case 143:	case 151:	case 159:	case 167:	case 175:	case 183:	case 191:
-		case 199:	case 207:	case 215:	case 223:	case 231:	case 239:	case 247:	case 255:
-			calc_pt1addr();
-			drawpixel();
-			break;
-		case 8:		case 16:		case 24:		case 32:		case 40:		case 48:		case 56:		case 64:
-		case 72:		case 80:		case 88:		case 96:		case 104:	case 112:	case 120:	case 128:
-		case 136:	case 144:	case 152:	case 160:	case 168:	case 176:	case 184:	case 192:
-		case 200:	case 208:	case 216:	case 224:	case 232:	case 240:	case 248:
-			fetch_pt1byte();
-			drawpixel();
-			inc_hscroll();
-			break;
-		case 256:
-			fetch_pt1byte();
-			drawpixel();
-			inc_hscroll();
-//			video_updateline(SCANLINE,nes->ppu.linebuffer);
+	//background fetches and pixel output
+	if(dot >= 1 && dot <= 256) {
+		fetch_tile_dot((dot - 1) & 7,((dot - 1) >> 3) + 2);
+		if(dot == 256)
 			inc_vscroll();
-			break;
+		if(nes->ppu.skipframe == 0)
+			drawpixel();
+		else if(CONTROL1 & 0x10)
+			sprite0_hit_check();
+	}
 
-		//garbage nametable address calc
-		case 257:
-#ifdef QUICK_SPRITES
-			quick_process_sprites();
-#endif
-			update_hscroll();
-		case 265:	case 273:	case 281:	case 289:	case 297:	case 305:	case 313:
-			calc_ntaddr();
-			break;
-
-		//garbage nametable fetch
-		case 258:	case 266:	case 274:	case 282:	case 290:	case 298:	case 306:	case 314:
-			break;
-
-		//garbage attribute address calc
-		case 259:	case 267:	case 275:	case 283:	case 291:	case 299:	case 307:	case 315:
-			calc_ataddr();
-			break;
-
-		//garbage attribute fetch
-		case 260:	case 268:	case 276:	case 284:	case 292:	case 300:	case 308:	case 316:
-			break;
-
-		//calculate address of sprite pattern low
-		case 261:	case 269:	case 277:	case 285:	case 293:	case 301:	case 309:	case 317:
-			calc_spt0addr();
-			break;
-
-		//fetch sprite pattern low
-		case 262:	case 270:	case 278:	case 286:	case 294:	case 302:	case 310:	case 318:
-			fetch_spt0byte();
-			break;
-
-		//calculate address of sprite pattern high
-		case 263:	case 271:	case 279:	case 287:	case 295:	case 303:	case 311:	case 319:
-			calc_spt1addr();
-			break;
-
-		//fetch sprite pattern high
-		case 264:	case 272:	case 280:	case 288:	case 296:	case 304:	case 312:
-			fetch_spt1byte();
-			break;
-		case 320:
-			fetch_spt1byte();
-//			nes->ppu.oamaddr = 0;
+	//sprite fetches and the first tiles of the next line
+	else if(dot > 256) {
+		fetch_hblank_dot(dot);
 #ifdef QUICK_SPRITES
+		if(dot == 320 && sprite_line_needed())
 			quick_draw_sprite_line();
 #endif
-			break;
-
-		//nametable byte for next scanline
-		case 321:	case 329:
-			calc_ntaddr();
-			break;
-		case 322:	case 330:
-			fetch_ntbyte();
-			break;
-
-		//attribute byte for next scanline
-		case 323:	case 331:
-			calc_ataddr();
-			break;
-		case 324:
-			fetch_atbyte(0);
-			break;
-		case 332:
-			fetch_atbyte(1);
-			break;
-
-		//pattern low byte tile
-		case 325:	case 333:
-			calc_pt0addr();
-			break;
-		case 326:
-			fetch_pt0byte(0);
-			break;
-		case 334:
-			fetch_pt0byte(1);
-			break;
-
-		//pattern high byte tile
-		case 327:	case 335:
-			calc_pt1addr();
-			break;
-		case 328:	case 336:
-			fetch_pt1byte();
-			inc_hscroll();
-			break;
-
-		//garbage nametable fetches
-		case 337:
-			calc_ntaddr();
-			break;
-		case 338:
-			fetch_ntbyte();
-			break;
-		case 339:
-//			calc_ntaddr();
-			break;
-		case 340:
-			fetch_ntbyte();
-			break;
 	}
 #ifndef QUICK_SPRITES
 	process_sprites();
@@ -561,7 +221,6 @@ static INLINE void scanline_visible()
 #endif
 }
 
-//scanlines in visible area with rendering disabled
 static INLINE void scanline_visible_norender()
 {
 	u8 color;
@@ -578,10 +237,69 @@ static INLINE void scanline_visible_norender()
 		}
 
 		//draw pixel
-		video_updatepixel(SCANLINE,LINECYCLES,color);
+		if(nes->ppu.skipframe == 0)
+			putpixel(LINECYCLES,color);
 	}
 }
 
+//see if the next visible line can be drawn all at once.  nothing may happen
+//mid-line that the dot-by-dot renderer would see: a delayed $2007 access, a
+//mapper watching the ppu bus, or a sprite 0 hit.  register writes cannot land
+//mid-line since the cpu syncs the ppu before each one.  on skipped frames the
+//sprite 0 hit is found for the whole line at once.
+static INLINE int scanline_is_static()
+{
+	if(nes->ppu.dotsonly || (CONTROL1 & 0x18) == 0 || nes->ppu.rendering == 0 || IOMODE)
+		return(0);
+	if((CONTROL1 & 0x10) && nes->ppu.spr0 && nes->ppu.skipframe == 0)
+		return(0);
+	if(nes->mapper->ppucycle != null_mapper_cycle)
+		return(0);
+	return(ppu_plainreads());
+}
+
+//a whole visible scanline with rendering enabled.  the tiles fetched during
+//dots 1-256 are never drawn before they are fetched or overwritten after, so
+//all the fetches are done first and then the line is drawn.
+static INLINE void scanline_visible_line()
+{
+	int i;
+
+	//background tiles (dots 1-256)
+	for(i=2;i<34;i++)
+		fetch_tile(i);
+	inc_vscroll();
+	if(nes->ppu.skipframe == 0)
+		drawline();
+	else if(CONTROL1 & 0x10)
+		sprite0_hit_line();
+
+	//sprites for the next line (dots 257-320)
+	quick_process_sprites();
+	update_hscroll();
+	for(i=0;i<8;i++) {
+		calc_spt0addr();
+		fetch_spt0byte();
+		calc_spt1addr();
+		fetch_spt1byte();
+	}
+	if(sprite_line_needed())
+		quick_draw_sprite_line();
+
+	//first two tiles for the next line (dots 321-336)
+	fetch_tile(0);
+	fetch_tile(1);
+
+	//garbage nametable fetches (dots 337-340)
+	calc_ntaddr();
+	fetch_ntbyte();
+	fetch_ntbyte();
+
+	//visible lines never end the frame
+	LINECYCLES = 0;
+	SCANLINE++;
+}
+
 //post render scanline
 static INLINE void scanline_postrender()
 {
@@ -598,7 +316,24 @@ static INLINE void scanline_startvblank()
 	}
 }
 
-void ppu_step()
+//dots until the next thing the cpu can see without reading a register
+//(nmi at vblank start, nmi line clear and the end of the frame)
+u32 ppu_nextevent()
+{
+	u32 pos = SCANLINE * 341 + LINECYCLES;
+	u32 vblank = nes->region->vblank_start * 341;
+	u32 end = nes->region->end_line * 341;
+
+	if(pos <= vblank)
+		return(vblank - pos + 1);
+	if(pos <= end + 3)
+		return(end + 3 - pos + 1);
+	return(end + 340 - pos + 1);
+}
+
+//step the ppu one dot.  the region lines are constants in each of the
+//ppu_run_* instances below, so the scanline checks compile down to immediates.
+static INLINE void step(u32 vblank_start,u32 end_line)
 {
 	u32 addr;
 
@@ -622,12 +357,12 @@ void ppu_step()
 	}
 
 	//first scanline of vblank
-	else if(SCANLINE == nes->region->vblank_start) {
+	else if(SCANLINE == vblank_start) {
 		scanline_startvblank();
 	}
 
 	//last line in the frame
-	else if(SCANLINE == nes->region->end_line) {
+	else if(SCANLINE == end_line) {
 		if(CONTROL1 & 0x18)
 			scanline_prerender();
 		else
@@ -670,5 +405,120 @@ void ppu_step()
 			nes->mapper->ppucycle();
 		}
 	}
-	inc_linecycles();
+	next_linecycle(end_line);
+}
+
+//first dot of the current line where step() does nothing but output the
+//backdrop color (341 when the line is rendered).  the dots before it are
+//vblank start, the post render line and the pre-render flag clears.
+static INLINE u32 idle_from(u32 vblank_start,u32 end_line)
+{
+	if(SCANLINE < 240)
+		return((CONTROL1 & 0x18) ? 341 : 0);
+	if(SCANLINE == 240 || SCANLINE == vblank_start)
+		return(1);
+	if(SCANLINE == end_line)
+		return((CONTROL1 & 0x18) ? 341 : 4);
+	return(0);
+}
+
+//see if the idle dots can be skipped over.  a delayed $2007 access or a
+//mapper watching the ppu bus needs every dot.
+static INLINE int idle_is_static()
+{
+	if(nes->ppu.dotsonly || IOMODE || nes->ppu.rendering)
+		return(0);
+	return(nes->mapper->ppucycle == null_mapper_cycle);
+}
+
+//run the idle dots of the current line at once, stopping before the last dot
+//so the line/frame change still goes thru step()
+static INLINE u32 run_idle(u32 dots)
+{
+	u32 n = 340 - LINECYCLES;
+	u32 end;
+	u8 color;
+
+	if(n > dots)
+		n = dots;
+
+	//backdrop color for a visible line with rendering off (same as
+	//scanline_visible_norender)
+	if(SCANLINE < 240 && LINECYCLES < 256 && nes->ppu.skipframe == 0) {
+		end = (LINECYCLES + n < 256) ? (LINECYCLES + n) : 256;
+		color = nes->ppu.control1 & 0xE0;
+		if((SCROLL & 0x3F00) == 0x3F00)
+			color |= SCROLL & 0x1F;
+		memset(nes->ppu.screen + (SCANLINE * 256) + LINECYCLES,color,end - LINECYCLES);
+	}
+
+	//the bus address is set on each odd dot
+	if(n >= 2 || (LINECYCLES & 1))
+		nes->ppu.busaddr = SCROLL;
+	LINECYCLES += n;
+	return(n);
+}
+
+//run the ppu for a number of dots, drawing whole visible lines at once and
+//skipping over idle dots when nothing can happen in the middle of them
+static INLINE void run(u32 dots,u32 vblank_start,u32 end_line)
+{
+	while(dots) {
+		if(dots >= 341 && LINECYCLES == 0 && SCANLINE < 240 && scanline_is_static()) {
+			scanline_visible_line();
+			dots -= 341;
+		}
+		else if(LINECYCLES < 340 && LINECYCLES >= idle_from(vblank_start,end_line) && idle_is_static())
+			dots -= run_idle(dots);
+		else {
+			step(vblank_start,end_line);
+			dots--;
+		}
+	}
+}
+
+void ppu_run_ntsc(u32 dots)
+{
+	run(dots,NTSC_VBLANK_START,NTSC_END_LINE);
+}
+
+void ppu_run_pal(u32 dots)
+{
+	run(dots,PAL_VBLANK_START,PAL_END_LINE);
+}
+
+void ppu_run_dendy(u32 dots)
+{
+	run(dots,DENDY_VBLANK_START,DENDY_END_LINE);
+}
+
+//run the ppu by itself for a number of frames, to time the renderer without
+//the cpu/apu.  the ppu and the interrupt lines are put back the way they were
+//afterwards.  mapper state can't be, so carts whose mapper watches the ppu
+//(ppucycle or read handlers) are refused.
+int ppu_bench(u32 frames,int lines)
+{
+	ppu_t *saved;
+	u8 nmistate = nes->cpu.nmistate;
+	u8 irqstate = nes->cpu.irqstate;
+	u32 dots = (nes->region->end_line + 1) * 341;
+
+	if(nes->mapper->ppucycle != null_mapper_cycle || ppu_plainreads() == 0)
+		return(1);
+	saved = (ppu_t*)mem_alloc(sizeof(ppu_t));
+	memcpy(saved,&nes->ppu,sizeof(ppu_t));
+	nes->ppu.dotsonly = lines ? 0 : 1;
+	while(frames--) {
+		switch(nes->region->id) {
+			default:
+			case REGION_NTSC:		ppu_run_ntsc(dots);		break;
+			case REGION_PAL:		ppu_run_pal(dots);		break;
+			case REGION_DENDY:	ppu_run_dendy(dots);		break;
+		}
+	}
+	memcpy(&nes->ppu,saved,sizeof(ppu_t));
+	nes->cpu.nmistate = nmistate;
+	nes->cpu.irqstate = irqstate;
+	mem_free(saved);
+	return(0);
 }
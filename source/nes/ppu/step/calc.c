@@ -63,17 +63,17 @@ static INLINE void calc_spt0addr()
 	//process 8x16 sprite
 	if(CONTROL0 & 0x20) {
 		//bank to get tile from
-		nes->ppu.busaddr = (sprtemp[nes->ppu.cursprite].tile & 1) << 12;
+		nes->ppu.busaddr = (nes->ppu.sprtemp[nes->ppu.cursprite].tile & 1) << 12;
 
 		//tile offset
-		nes->ppu.busaddr += (sprtemp[nes->ppu.cursprite].tile & 0xFE) * 16;
+		nes->ppu.busaddr += (nes->ppu.sprtemp[nes->ppu.cursprite].tile & 0xFE) * 16;
 
 		//vertical flip offset
-		nes->ppu.busaddr += (sprtemp[nes->ppu.cursprite].flags & 0x80) >> 3;
+		nes->ppu.busaddr += (nes->ppu.sprtemp[nes->ppu.cursprite].flags & 0x80) >> 3;
 
 		//if this is the lower half of an 8x16 sprite
-		if(sprtemp[nes->ppu.cursprite].flags & 0x20) {
-			if(sprtemp[nes->ppu.cursprite].flags & 0x80)
+		if(nes->ppu.sprtemp[nes->ppu.cursprite].flags & 0x20) {
+			if(nes->ppu.sprtemp[nes->ppu.cursprite].flags & 0x80)
 				nes->ppu.busaddr -= 16;
 			else
 				nes->ppu.busaddr += 16;
@@ -87,11 +87,11 @@ static INLINE void calc_spt0addr()
 		nes->ppu.busaddr = (CONTROL0 & 8) << 9;
 
 		//tile offset
-		nes->ppu.busaddr += sprtemp[nes->ppu.cursprite].tile * 16;
+		nes->ppu.busaddr += nes->ppu.sprtemp[nes->ppu.cursprite].tile * 16;
 	}
 
 	//tile line offset
-	nes->ppu.busaddr += sprtemp[nes->ppu.cursprite].sprline * 2;
+	nes->ppu.busaddr += nes->ppu.sprtemp[nes->ppu.cursprite].sprline * 2;
 }
 
 //calculate sprite tile pattern table high byte address
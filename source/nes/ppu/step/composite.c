@@ -0,0 +1,203 @@
+/***************************************************************************
+ *   Copyright (C) 2013 by James Holodnak                                  *
+ *   jamesholodnak@gmail.com                                               *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+//background/sprite compositing for a whole line.  sse2 is the baseline on
+//any x86-64 build (plain c otherwise), avx2 is built with a target attribute
+//and picked at init when the cpu has it (see ppu_composite_init).
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+	#include <emmintrin.h>
+	#define COMPOSITE_SSE2
+#endif
+
+#if defined(COMPOSITE_SSE2) && defined(__GNUC__)
+	#include <immintrin.h>
+	#define COMPOSITE_AVX2
+	#define AVX2_FUNC __attribute__((target("avx2")))
+#elif defined(COMPOSITE_SSE2) && defined(_MSC_VER)
+	#include <immintrin.h>
+	#include <intrin.h>
+	#define COMPOSITE_AVX2
+	#define AVX2_FUNC
+#endif
+
+//mask for the left 8 pixels being hidden
+static const u8 leftclip[32] = {
+	0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,
+	0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF
+};
+
+//the rules for each pixel, same as drawpixel():
+//  background pixels with color 0 are transparent and output as 0
+//  a non-transparent sprite pixel wins if it is in front (bit 4 clear) or
+//    the background is transparent, and gets bit 4 set in the output
+//  emphasis bits are or'd in last
+//bgstart/sprstart are the first visible pixel (0, 8 or 256 when disabled)
+
+#if defined(COMPOSITE_AVX2)
+
+AVX2_FUNC static INLINE __m256i composite_mask_avx2(int start,int first)
+{
+	if(start == 0 || (start == 8 && first == 0))
+		return(_mm256_set1_epi8(-1));
+	if(start == 8)
+		return(_mm256_loadu_si256((__m256i*)leftclip));
+	return(_mm256_setzero_si256());
+}
+
+AVX2_FUNC static void composite_line_avx2(u8 *dest,u8 *bg,u8 *spr,int bgstart,int sprstart,u8 emphasis)
+{
+	__m256i three = _mm256_set1_epi8(3);
+	__m256i prio = _mm256_set1_epi8(0x10);
+	__m256i zero = _mm256_setzero_si256();
+	__m256i emph = _mm256_set1_epi8((char)emphasis);
+	__m256i bgmask = composite_mask_avx2(bgstart,1);
+	__m256i sprmask = composite_mask_avx2(sprstart,1);
+	__m256i b,s,bclear,sclear,sfront,take;
+	int pos;
+
+	for(pos=0;pos<256;pos+=32) {
+		b = _mm256_and_si256(_mm256_loadu_si256((__m256i*)(bg + pos)),bgmask);
+		s = _mm256_and_si256(_mm256_loadu_si256((__m256i*)(spr + pos)),sprmask);
+
+		//transparent background/sprite pixels
+		bclear = _mm256_cmpeq_epi8(_mm256_and_si256(b,three),zero);
+		sclear = _mm256_cmpeq_epi8(_mm256_and_si256(s,three),zero);
+		sfront = _mm256_cmpeq_epi8(_mm256_and_si256(s,prio),zero);
+		b = _mm256_andnot_si256(bclear,b);
+
+		//sprite pixels that win over the background
+		take = _mm256_andnot_si256(sclear,_mm256_or_si256(sfront,bclear));
+		b = _mm256_blendv_epi8(b,_mm256_or_si256(s,prio),take);
+		_mm256_storeu_si256((__m256i*)(dest + pos),_mm256_or_si256(b,emph));
+
+		//only the first block can be clipped
+		bgmask = composite_mask_avx2(bgstart,0);
+		sprmask = composite_mask_avx2(sprstart,0);
+	}
+}
+
+static int supported_avx2()
+{
+#if defined(_MSC_VER)
+	int info[4];
+
+	//avx2 also needs the os to save the ymm registers
+	__cpuid(info,1);
+	if(((info[2] >> 27) & 3) != 3 || (_xgetbv(0) & 6) != 6)
+		return(0);
+	__cpuidex(info,7,0);
+	return((info[1] >> 5) & 1);
+#else
+	__builtin_cpu_init();
+	return(__builtin_cpu_supports("avx2") ? 1 : 0);
+#endif
+}
+
+#endif
+
+#if defined(COMPOSITE_SSE2)
+
+static INLINE __m128i composite_mask(int start,int first)
+{
+	if(start == 0 || (start == 8 && first == 0))
+		return(_mm_set1_epi8(-1));
+	if(start == 8)
+		return(_mm_loadu_si128((__m128i*)leftclip));
+	return(_mm_setzero_si128());
+}
+
+static void composite_line_sse2(u8 *dest,u8 *bg,u8 *spr,int bgstart,int sprstart,u8 emphasis)
+{
+	__m128i three = _mm_set1_epi8(3);
+	__m128i prio = _mm_set1_epi8(0x10);
+	__m128i zero = _mm_setzero_si128();
+	__m128i emph = _mm_set1_epi8((char)emphasis);
+	__m128i bgmask = composite_mask(bgstart,1);
+	__m128i sprmask = composite_mask(sprstart,1);
+	__m128i b,s,bclear,sclear,sfront,take;
+	int pos;
+
+	for(pos=0;pos<256;pos+=16) {
+		b = _mm_and_si128(_mm_loadu_si128((__m128i*)(bg + pos)),bgmask);
+		s = _mm_and_si128(_mm_loadu_si128((__m128i*)(spr + pos)),sprmask);
+
+		//transparent background/sprite pixels
+		bclear = _mm_cmpeq_epi8(_mm_and_si128(b,three),zero);
+		sclear = _mm_cmpeq_epi8(_mm_and_si128(s,three),zero);
+		sfront = _mm_cmpeq_epi8(_mm_and_si128(s,prio),zero);
+		b = _mm_andnot_si128(bclear,b);
+
+		//sprite pixels that win over the background
+		take = _mm_andnot_si128(sclear,_mm_or_si128(sfront,bclear));
+		b = _mm_or_si128(_mm_and_si128(take,_mm_or_si128(s,prio)),_mm_andnot_si128(take,b));
+		_mm_storeu_si128((__m128i*)(dest + pos),_mm_or_si128(b,emph));
+
+		//only the first block can be clipped
+		bgmask = composite_mask(bgstart,0);
+		sprmask = composite_mask(sprstart,0);
+	}
+}
+
+#endif
+
+static void composite_line_c(u8 *dest,u8 *bg,u8 *spr,int bgstart,int sprstart,u8 emphasis)
+{
+	u8 output,pixel;
+	int pos;
+
+	for(pos=0;pos<256;pos++) {
+		output = 0;
+
+		//background pixel
+		if(pos >= bgstart) {
+			pixel = bg[pos];
+			if(pixel & 3)
+				output = pixel;
+		}
+
+		//sprite pixel with priority
+		if(pos >= sprstart) {
+			pixel = spr[pos];
+			if(pixel & 3) {
+				if((pixel & 0x10) == 0 || (output & 3) == 0)
+					output = pixel | 0x10;
+			}
+		}
+		dest[pos] = output | emphasis;
+	}
+}
+
+//compositing function used by drawline().  it only depends on the cpu, so
+//it is picked once by the first ppu_composite_init and shared by every thread.
+static void (*composite_line)(u8*,u8*,u8*,int,int,u8) = 0;
+
+void ppu_composite_init()
+{
+	if(composite_line)
+		return;
+	composite_line = composite_line_c;
+#if defined(COMPOSITE_SSE2)
+	composite_line = composite_line_sse2;
+#endif
+#if defined(COMPOSITE_AVX2)
+	if(supported_avx2())
+		composite_line = composite_line_avx2;
+#endif
+}
@@ -18,6 +18,12 @@
  *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
  ***************************************************************************/
 
+//output one pixel to the screen
+static INLINE void putpixel(int pos,u8 color)
+{
+	nes->ppu.screen[(SCANLINE * 256) + pos] = color;
+}
+
 static INLINE void drawpixel()
 {
 	int pos = LINECYCLES - 1;
@@ -56,13 +62,27 @@ static INLINE void drawpixel()
 	//apply color emphasis
 	output |= nes->ppu.control1 & 0xE0;
 
-	//output pixel to the renderer
-	video_updatepixel(SCANLINE,pos,output);
+	//output pixel to the screen
+	putpixel(pos,output);
+}
+
+//draw a whole line of pixels.  same as calling drawpixel() for dots 1-256,
+//but the sprite 0 hit check is left out so it must not be pending.
+static INLINE void drawline()
+{
+	int bgstart,sprstart;
+
+	//first pixel the background/sprites are visible on
+	bgstart = (CONTROL1 & 8) ? ((CONTROL1 & 2) ? 0 : 8) : 256;
+	sprstart = (CONTROL1 & 0x10) ? ((CONTROL1 & 4) ? 0 : 8) : 256;
+
+	//composite the line straight into the screen
+	composite_line(nes->ppu.screen + (SCANLINE * 256),nes->ppu.tilebuffer + nes->ppu.scrollx,nes->ppu.spritebuffer,bgstart,sprstart,nes->ppu.control1 & 0xE0);
 }
 
 static INLINE void quick_draw_sprite_line()
 {
-	sprtemp_t *spr = (sprtemp_t*)sprtemp + 7;
+	sprtemp_t *spr = (sprtemp_t*)nes->ppu.sprtemp + 7;
 	u64 *spriteline64 = (u64*)nes->ppu.spritebuffer;
 	int n;
 
@@ -45,6 +45,10 @@ static INLINE void fetch_pt0byte(int tilenum)
 	//perform the read, but throw the data away
 	ppu_memread(nes->ppu.busaddr);
 
+	//update cache for vram tiles written since the last fetch
+	if(nes->ppu.cachedirty)
+		ppu_flushtiles();
+
 	//tile bank cache pointer
 	cache = nes->ppu.cachepages[(nes->ppu.ntbyte >> 6) | ((CONTROL0 & 0x10) >> 2)];
 
@@ -70,22 +74,33 @@ static INLINE void fetch_pt1byte()
 static INLINE void fetch_spt0byte()
 {
 	cache_t *cache;
+	int flip = 0;
 
 	//perform the read, but throw the data away
 	ppu_memread(nes->ppu.busaddr);
 
-	//get cache bank used by sprite tile
-	if(sprtemp[nes->ppu.cursprite].flags & 0x40)
-		cache = nes->ppu.cachepages_hflip[(nes->ppu.busaddr >> 10) & 7];
-	else
-		cache = nes->ppu.cachepages[(nes->ppu.busaddr >> 10) & 7];
+	//update cache for vram tiles written since the last fetch
+	if(nes->ppu.cachedirty)
+		ppu_flushtiles();
+
+	//get cache bank used by sprite tile (flipped rows are derived from the
+	//normal cache when there is no hflip copy)
+	cache = nes->ppu.cachepages[(nes->ppu.busaddr >> 10) & 7];
+	if(nes->ppu.sprtemp[nes->ppu.cursprite].flags & 0x40) {
+		if(nes->ppu.cachepages_hflip[(nes->ppu.busaddr >> 10) & 7])
+			cache = nes->ppu.cachepages_hflip[(nes->ppu.busaddr >> 10) & 7];
+		else
+			flip = 1;
+	}
 
 	//offset to the current tile line
 	cache += (nes->ppu.busaddr & 0x3FF) / 8;
 
 	//store sprite tile line
-	sprtemp[nes->ppu.cursprite].line = *cache >> (nes->ppu.busaddr & 6);
-	sprtemp[nes->ppu.cursprite].line &= CACHE_MASK;
+	nes->ppu.sprtemp[nes->ppu.cursprite].line = *cache >> (nes->ppu.busaddr & 6);
+	nes->ppu.sprtemp[nes->ppu.cursprite].line &= CACHE_MASK;
+	if(flip)
+		nes->ppu.sprtemp[nes->ppu.cursprite].line = cache_flip(nes->ppu.sprtemp[nes->ppu.cursprite].line);
 }
 
 static INLINE void fetch_spt1byte()
@@ -18,19 +18,39 @@
  *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
  ***************************************************************************/
 
-static INLINE void inc_linecycles()
+//decide if the frame starting now is drawn.  with frameskip set to n, one
+//frame is drawn and then n are skipped.
+static INLINE void start_frame()
+{
+	if((int)nes->ppu.skipcount < configcache.frameskip) {
+		nes->ppu.skipcount++;
+		nes->ppu.skipframe = 1;
+	}
+	else {
+		nes->ppu.skipcount = 0;
+		nes->ppu.skipframe = 0;
+	}
+}
+
+static INLINE void next_linecycle(u32 end_line)
 {
 	LINECYCLES++;
 	if(LINECYCLES >= 341) {
 		LINECYCLES = 0;
 		SCANLINE++;
-		if(SCANLINE > nes->region->end_line) {
+		if(SCANLINE > end_line) {
 			SCANLINE = 0;
 			FRAMES++;
+			start_frame();
 		}
 	}
 }
 
+static INLINE void inc_linecycles()
+{
+	next_linecycle(nes->region->end_line);
+}
+
 static INLINE void skip_cycle()
 {
 	//ensure we are not in pal mode
@@ -145,19 +145,45 @@ static INLINE draw_sprites()
 
 #else
 
+#if defined(_MSC_VER) && defined(_M_X64)
+	#include <intrin.h>
+#endif
+
+//index of the lowest set bit of n (n must not be 0)
+static INLINE int lowest_bit(u64 n)
+{
+#if defined(__GNUC__)
+	return(__builtin_ctzll(n));
+#elif defined(_MSC_VER) && defined(_M_X64)
+	unsigned long ret;
+
+	_BitScanForward64(&ret,n);
+	return((int)ret);
+#else
+	int ret = 0;
+
+	while((n & 1) == 0) {
+		n >>= 1;
+		ret++;
+	}
+	return(ret);
+#endif
+}
+
 //process all sprites that belong to the next scanline
 static INLINE void quick_process_sprites()
 {
 	int i,h,sprinrange,sprline;
 	u8 *s;
+	u64 sprites;
 	int line = SCANLINE == nes->region->end_line ? -1 : SCANLINE;	//kludge
 
 	//clear the sprite temp memory
 	for(i=0;i<8;i++) {
-		sprtemp[i].line = 0;
-		sprtemp[i].attr = sprtemp[i].x = sprtemp[i].flags = 0;
-		sprtemp[i].tile = 0xFF;
-		sprtemp[i].sprline = 0;
+		nes->ppu.sprtemp[i].line = 0;
+		nes->ppu.sprtemp[i].attr = nes->ppu.sprtemp[i].x = nes->ppu.sprtemp[i].flags = 0;
+		nes->ppu.sprtemp[i].tile = 0xFF;
+		nes->ppu.sprtemp[i].sprline = 0;
 	}
 
 	//if sprites disabled, return
@@ -167,63 +193,90 @@ static INLINE void quick_process_sprites()
 	//determine sprite height
 	h = 8 + ((CONTROL0 & 0x20) >> 2);
 
-	spr0 = 0;
+	nes->ppu.spr0 = 0;
+
+	//sprites on this line, from the line index kept by oam writes
+	if(nes->ppu.spriteheight != h)
+		ppu_buildspritelines();
+	sprites = (line >= 0 && line < 256) ? nes->ppu.spritelines[line] : 0;
 
-	//loop thru all 64 visible sprites, keeping note of the first eight visible
-	for(sprinrange=0,i=0;i<64;i++) {
+	//loop thru the sprites on this line, keeping the first eight
+	for(sprinrange=0;sprites;sprites&=sprites-1) {
 
-		//sprite data pointer
+		//sprite number and data pointer
+		i = lowest_bit(sprites);
 		s = &nes->ppu.oam[i * 4];
 
 		//get the sprite tile line to draw
 		sprline = line - s[0];
 
-		//check for visibility on this line
-		if(sprline >= 0 && sprline < h) {
-
-			//if more than 8 sprites are found, set the flag and exit the loop
-			if(sprinrange == 8) {
-				STATUS |= 0x20;
-				break;
-			}
+		//if more than 8 sprites are found, set the flag and exit the loop
+		if(sprinrange == 8) {
+			STATUS |= 0x20;
+			break;
+		}
 
-			//copy sprite data to temp memory
-			sprtemp[sprinrange].attr = (s[2] & 3) | ((s[2] & 0x20) >> 3);
-			sprtemp[sprinrange].x = s[3];
-			sprtemp[sprinrange].flags = 1 | (s[2] & 0xC0);
-			sprtemp[sprinrange].tile = s[1];
+		//copy sprite data to temp memory
+		nes->ppu.sprtemp[sprinrange].attr = (s[2] & 3) | ((s[2] & 0x20) >> 3);
+		nes->ppu.sprtemp[sprinrange].x = s[3];
+		nes->ppu.sprtemp[sprinrange].flags = 1 | (s[2] & 0xC0);
+		nes->ppu.sprtemp[sprinrange].tile = s[1];
 
-			//if sprite0 check is needed
-			if(i == 0 && (STATUS & 0x40) == 0) {
-				sprtemp[sprinrange].flags |= 2;
-				spr0 = &sprtemp[sprinrange];
-			}
+		//if sprite0 check is needed
+		if(i == 0 && (STATUS & 0x40) == 0) {
+			nes->ppu.sprtemp[sprinrange].flags |= 2;
+			nes->ppu.spr0 = &nes->ppu.sprtemp[sprinrange];
+		}
 
-			//small kludge for 8x16 sprites
-			if(CONTROL0 & 0x20) {
-				if(sprline >= 8) {
-					sprtemp[sprinrange].flags |= 0x20;
-					sprline &= 7;
-				}
+		//small kludge for 8x16 sprites
+		if(CONTROL0 & 0x20) {
+			if(sprline >= 8) {
+				nes->ppu.sprtemp[sprinrange].flags |= 0x20;
+				sprline &= 7;
 			}
+		}
 
-			//if sprite is to be flipped vertically
-			if((s[2] & 0x80) != 0)
-				sprline = 7 - sprline;
+		//if sprite is to be flipped vertically
+		if((s[2] & 0x80) != 0)
+			sprline = 7 - sprline;
 
-			//save sprite tile line
-			sprtemp[sprinrange].sprline = sprline;
+		//save sprite tile line
+		nes->ppu.sprtemp[sprinrange].sprline = sprline;
 
-			//increment sprite in range counter
-			sprinrange++;
+		//increment sprite in range counter
+		sprinrange++;
+	}
+}
 
+//sprite 0 hit for a whole line, for when the line is not drawn.  same result
+//as calling sprite0_hit_check() for dots 1-256 once the tiles are fetched.
+static INLINE void sprite0_hit_line()
+{
+	u8 *line;
+	int x,xpos;
+
+	if(nes->ppu.spr0 == 0 || (CONTROL1 & 8) == 0)
+		return;
+	if(((CONTROL1 & 4) == 0 && nes->ppu.spr0->x == 0) || nes->ppu.spr0->x == 255)
+		return;
+	line = (u8*)&nes->ppu.spr0->line;
+	for(xpos=0;xpos<8;xpos++) {
+		x = nes->ppu.spr0->x + xpos;
+		if(x >= 255)
+			break;
+		if(x < 8 && (CONTROL1 & 2) == 0)
+			continue;
+		if(nes->ppu.tilebuffer[x] && line[xpos]) {
+			STATUS |= 0x40;
+			nes->ppu.spr0 = 0;
+			return;
 		}
 	}
 }
 
 static INLINE void sprite0_hit_check()
 {
-	if(spr0 != 0) {
+	if(nes->ppu.spr0 != 0) {
 		u8 *dest = nes->ppu.tilebuffer;
 		u8 *line;
 		int xpos;
@@ -235,15 +288,15 @@ static INLINE void sprite0_hit_check()
 		//if background is not visible in left 8 pixels, always miss
 		if(x < 8 && (CONTROL1 & 2) == 0)
 			return;
-		xpos = x - spr0->x;
+		xpos = x - nes->ppu.spr0->x;
 		if(xpos >= 0 && xpos < 8) {
-			if(((CONTROL1 & 4) == 0 && spr0->x == 0) || spr0->x == 255 || x == 255)
+			if(((CONTROL1 & 4) == 0 && nes->ppu.spr0->x == 0) || nes->ppu.spr0->x == 255 || x == 255)
 				return;
 			dest += x;
-			line = (u8*)&spr0->line;
+			line = (u8*)&nes->ppu.spr0->line;
 			if(*dest && line[xpos]) {
 				STATUS |= 0x40;
-				spr0 = 0;
+				nes->ppu.spr0 = 0;
 			}
 		}
 	}
@@ -21,87 +21,267 @@
 #include "nes/ppu/tilecache.h"
 
 //blargg's wonderful cache scheme, found on nesdev forums
+//
+//each tile is cached as two u64's of four rows each.  every byte is one
+//pixel and holds the two bitplanes of all four rows, row n in bits 2n/2n+1.
+//the hflip cache is the same with the pixels (bytes) in reverse order.
+//
+//the conversion kernel is picked the first time a tile is converted, the
+//fastest one the cpu supports is used.
 
-// Expands each of the 8 bits in n into separate bytes of result.
-// In: 12345678  Out: 0x87654321
+//spread the 8 bits of n into separate bytes of the result (msb first)
+//In: 12345678  Out: 0x0807060504030201
 static INLINE u64 expand(u8 n)
 {
-	u64 ret = 0;
+	u64 ret = (u64)n * 0x0101010101010101ULL;
 
-	ret |= (u64)((n >> 7) & 1) << 0;
-	ret |= (u64)((n >> 6) & 1) << 8;
-	ret |= (u64)((n >> 5) & 1) << 16;
-	ret |= (u64)((n >> 4) & 1) << 24;
-	ret |= (u64)((n >> 3) & 1) << 32;
-	ret |= (u64)((n >> 2) & 1) << 40;
-	ret |= (u64)((n >> 1) & 1) << 48;
-	ret |= (u64)((n >> 0) & 1) << 56;
-	return(ret);
+	ret &= 0x0102040810204080LL;
+	return(((ret + 0x7F7F7F7F7F7F7F7FLL) >> 7) & 0x0101010101010101LL);
 }
 
-// Expands each of the 8 bits in n into separate bytes of result.
-// In: 12345678  Out: 0x87654321
-static INLINE u64 expand_hflip(u8 n)
+static void convert_scalar(u8 *chr,cache_t *cache,cache_t *cache_hflip,int num)
 {
-	u64 ret = 0;
+	cache_t row;
+	int n,i;
 
-	ret |= (u64)((n >> 0) & 1) << 0;
-	ret |= (u64)((n >> 1) & 1) << 8;
-	ret |= (u64)((n >> 2) & 1) << 16;
-	ret |= (u64)((n >> 3) & 1) << 24;
-	ret |= (u64)((n >> 4) & 1) << 32;
-	ret |= (u64)((n >> 5) & 1) << 40;
-	ret |= (u64)((n >> 6) & 1) << 48;
-	ret |= (u64)((n >> 7) & 1) << 56;
-	return(ret);
+	for(n=0;n<num;n++,chr+=16) {
+		for(i=0;i<2;i++) {
+			row =	(expand(chr[i * 4 + 0]) << 0) |
+					(expand(chr[i * 4 + 8]) << 1) |
+					(expand(chr[i * 4 + 1]) << 2) |
+					(expand(chr[i * 4 + 9]) << 3) |
+					(expand(chr[i * 4 + 2]) << 4) |
+					(expand(chr[i * 4 + 10]) << 5) |
+					(expand(chr[i * 4 + 3]) << 6) |
+					(expand(chr[i * 4 + 11]) << 7);
+			if(cache)
+				*cache++ = row;
+			if(cache_hflip)
+				*cache_hflip++ = cache_flip(row);
+		}
+	}
 }
 
-// convert one chr tile to a cached tile
-void cache_tile(u8 *chr,cache_t *cache)
+static int supported_scalar()
+{
+	return(1);
+}
+
+//sse2:  with the tile bytes interleaved, each 64bit lane holds the eight
+//bitplane rows of one half of the tile and the conversion is an 8x8 bit
+//transpose of each lane (hacker's delight), which gives the flipped rows.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+	#include <emmintrin.h>
+	#define CACHE_SSE2
+#endif
+
+#ifdef CACHE_SSE2
+
+//swap the bits of v selected by mask with the ones shift bits above them
+static INLINE __m128i delta_swap(__m128i v,__m128i mask,int shift)
+{
+	__m128i t = _mm_and_si128(_mm_xor_si128(v,_mm_srli_epi64(v,shift)),mask);
+
+	return(_mm_xor_si128(_mm_xor_si128(v,t),_mm_slli_epi64(t,shift)));
+}
+
+static INLINE __m128i transpose_lanes(__m128i v)
+{
+	v = delta_swap(v,_mm_set1_epi32(0x00AA00AA),7);
+	v = delta_swap(v,_mm_set1_epi32(0x0000CCCC),14);
+	return(delta_swap(v,_mm_set_epi32(0,0xF0F0F0F0,0,0xF0F0F0F0),28));
+}
+
+static void convert_sse2(u8 *chr,cache_t *cache,cache_t *cache_hflip,int num)
 {
+	__m128i v;
 	int n;
 
-	for(n=2;n--;) {
-		*cache++ =	(expand(chr[ 0]) << 0) |
-						(expand(chr[ 8]) << 1) |
-						(expand(chr[ 1]) << 2) |
-						(expand(chr[ 9]) << 3) |
-						(expand(chr[ 2]) << 4) |
-						(expand(chr[10]) << 5) |
-						(expand(chr[ 3]) << 6) |
-						(expand(chr[11]) << 7);
-		chr += 4;
+	for(n=0;n<num;n++,chr+=16) {
+		v = _mm_loadu_si128((__m128i*)chr);
+		v = transpose_lanes(_mm_unpacklo_epi8(v,_mm_srli_si128(v,8)));
+		if(cache_hflip) {
+			_mm_storeu_si128((__m128i*)cache_hflip,v);
+			cache_hflip += 2;
+		}
+		if(cache) {
+			//reverse the bytes of each lane
+			v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v,0x1B),0x1B);
+			v = _mm_or_si128(_mm_slli_epi16(v,8),_mm_srli_epi16(v,8));
+			_mm_storeu_si128((__m128i*)cache,v);
+			cache += 2;
+		}
 	}
 }
 
-// convert one chr tile to a cached tile, horizontally flipped
-void cache_tile_hflip(u8 *chr,cache_t *cache)
+static int supported_sse2()
+{
+	return(1);
+}
+
+#endif
+
+//ssse3:  same as sse2, with pshufb doing the interleave and byte reversal
+#if defined(CACHE_SSE2) && defined(__GNUC__)
+	#include <tmmintrin.h>
+	#define CACHE_SSSE3
+	#define SSSE3_FUNC __attribute__((target("ssse3")))
+#elif defined(CACHE_SSE2) && defined(_MSC_VER)
+	#include <tmmintrin.h>
+	#include <intrin.h>
+	#define CACHE_SSSE3
+	#define SSSE3_FUNC
+#endif
+
+#ifdef CACHE_SSSE3
+
+SSSE3_FUNC static void convert_ssse3(u8 *chr,cache_t *cache,cache_t *cache_hflip,int num)
 {
+	__m128i interleave = _mm_setr_epi8(0,8,1,9,2,10,3,11,4,12,5,13,6,14,7,15);
+	__m128i reverse = _mm_setr_epi8(7,6,5,4,3,2,1,0,15,14,13,12,11,10,9,8);
+	__m128i v;
 	int n;
 
-	for(n=2;n--;) {
-		*cache++ =	(expand_hflip(chr[ 0]) << 0) |
-						(expand_hflip(chr[ 8]) << 1) |
-						(expand_hflip(chr[ 1]) << 2) |
-						(expand_hflip(chr[ 9]) << 3) |
-						(expand_hflip(chr[ 2]) << 4) |
-						(expand_hflip(chr[10]) << 5) |
-						(expand_hflip(chr[ 3]) << 6) |
-						(expand_hflip(chr[11]) << 7);
-		chr += 4;
+	for(n=0;n<num;n++,chr+=16) {
+		v = _mm_shuffle_epi8(_mm_loadu_si128((__m128i*)chr),interleave);
+		v = transpose_lanes(v);
+		if(cache_hflip) {
+			_mm_storeu_si128((__m128i*)cache_hflip,v);
+			cache_hflip += 2;
+		}
+		if(cache) {
+			_mm_storeu_si128((__m128i*)cache,_mm_shuffle_epi8(v,reverse));
+			cache += 2;
+		}
 	}
 }
 
-void cache_tiles(u8 *chr,cache_t *cache,int num,int hflip)
+static int supported_ssse3()
 {
-	int n;
+#if defined(_MSC_VER)
+	int info[4];
+
+	__cpuid(info,1);
+	return((info[2] >> 9) & 1);
+#else
+	__builtin_cpu_init();
+	return(__builtin_cpu_supports("ssse3") ? 1 : 0);
+#endif
+}
+
+#endif
+
+//bmi2:  pdep drops each bit of a bitplane row straight into its pixel byte.
+//this builds the flipped row (bit 0 goes to the first byte), the normal row
+//is the byte swapped version.
+#if defined(__GNUC__) && defined(__x86_64__)
+	#include <immintrin.h>
+	#define CACHE_BMI2
+	#define BMI2_FUNC __attribute__((target("bmi2")))
+#elif defined(_MSC_VER) && defined(_M_X64)
+	#include <immintrin.h>
+	#include <intrin.h>
+	#define CACHE_BMI2
+	#define BMI2_FUNC
+#endif
+
+#ifdef CACHE_BMI2
+#define PDEP(n,shift)	_pdep_u64(n,0x0101010101010101LL << (shift))
 
-	for(n=0;n<num;n++) {
-		if(hflip != 0)
-			cache_tile_hflip(chr,cache);
-		else
-			cache_tile(chr,cache);
-		chr += 16;
-		cache += CACHE_TILE_SIZE;
+BMI2_FUNC static void convert_bmi2(u8 *chr,cache_t *cache,cache_t *cache_hflip,int num)
+{
+	cache_t row;
+	int n,i;
+
+	for(n=0;n<num;n++,chr+=16) {
+		for(i=0;i<2;i++) {
+			row =	PDEP(chr[i * 4 + 0],0) |
+					PDEP(chr[i * 4 + 8],1) |
+					PDEP(chr[i * 4 + 1],2) |
+					PDEP(chr[i * 4 + 9],3) |
+					PDEP(chr[i * 4 + 2],4) |
+					PDEP(chr[i * 4 + 10],5) |
+					PDEP(chr[i * 4 + 3],6) |
+					PDEP(chr[i * 4 + 11],7);
+			if(cache)
+				*cache++ = cache_flip(row);
+			if(cache_hflip)
+				*cache_hflip++ = row;
+		}
 	}
 }
+
+static int supported_bmi2()
+{
+#if defined(_MSC_VER)
+	int info[4];
+
+	__cpuidex(info,7,0);
+	return((info[1] >> 8) & 1);
+#else
+	__builtin_cpu_init();
+	return(__builtin_cpu_supports("bmi2") ? 1 : 0);
+#endif
+}
+#endif
+
+//available kernels, fastest first.  pdep needs one instruction per chr byte,
+//the transposes do a whole tile in a handful so they are preferred.
+cachekernel_t cache_kernels[] = {
+#ifdef CACHE_SSSE3
+	{"ssse3",	supported_ssse3,	convert_ssse3},
+#endif
+#ifdef CACHE_SSE2
+	{"sse2",		supported_sse2,	convert_sse2},
+#endif
+#ifdef CACHE_BMI2
+	{"bmi2",		supported_bmi2,	convert_bmi2},
+#endif
+	{"scalar",	supported_scalar,	convert_scalar},
+	{0,0,0}
+};
+
+//kernel picked on first use.  the choice only depends on the cpu, so it is
+//the same for every instance and thread.
+static cachekernel_t *kernel = 0;
+
+cachekernel_t *cache_getkernel()
+{
+	cachekernel_t *k;
+
+	if(kernel == 0) {
+		for(k=cache_kernels;k->name;k++) {
+			if(k->supported()) {
+				kernel = k;
+				break;
+			}
+		}
+	}
+	return(kernel);
+}
+
+// convert one chr tile to a cached tile
+void cache_tile(u8 *chr,cache_t *cache)
+{
+	cache_getkernel()->convert(chr,cache,0,1);
+}
+
+// convert one chr tile to a cached tile, horizontally flipped
+void cache_tile_hflip(u8 *chr,cache_t *cache)
+{
+	cache_getkernel()->convert(chr,0,cache,1);
+}
+
+void cache_tiles(u8 *chr,cache_t *cache,int num,int hflip)
+{
+	if(hflip != 0)
+		cache_getkernel()->convert(chr,0,cache,num);
+	else
+		cache_getkernel()->convert(chr,cache,0,num);
+}
+
+// convert chr tiles to both the normal and flipped cache (either can be 0)
+void cache_tiles_both(u8 *chr,cache_t *cache,cache_t *cache_hflip,int num)
+{
+	cache_getkernel()->convert(chr,cache,cache_hflip,num);
+}
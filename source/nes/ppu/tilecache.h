@@ -23,13 +23,39 @@
 
 #include "types.h"
 
+#if defined(_MSC_VER)
+	#include <stdlib.h>
+#endif
+
 #define CACHE_TILE_SIZE		2
 #define CACHE_MASK			0x0303030303030303LL
 
 typedef u64 cache_t;
 
+//horizontally flip a cached tile row (one pixel per byte)
+static INLINE cache_t cache_flip(cache_t n)
+{
+#if defined(_MSC_VER)
+	return(_byteswap_uint64(n));
+#else
+	return(__builtin_bswap64(n));
+#endif
+}
+
+//tile conversion kernel
+typedef struct cachekernel_s {
+	const char *name;
+	int (*supported)();
+	void (*convert)(u8 *chr,cache_t *cache,cache_t *cache_hflip,int num);
+} cachekernel_t;
+
+//all kernels built in, terminated by an entry with a null name
+extern cachekernel_t cache_kernels[];
+
+cachekernel_t *cache_getkernel();
 void cache_tile(u8 *chr,cache_t *cache);
 void cache_tile_hflip(u8 *chr,cache_t *cache);
 void cache_tiles(u8 *chr,cache_t *cache,int num,int hflip);
+void cache_tiles_both(u8 *chr,cache_t *cache,cache_t *cache_hflip,int num);
 
 #endif
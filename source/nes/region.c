@@ -25,21 +25,21 @@ region_t region_ntsc = {
 	REGION_NTSC,
 	60,
 	236250000 / 11,
-	241,261
+	NTSC_VBLANK_START,NTSC_END_LINE
 };
 
 region_t region_pal = {
 	REGION_PAL,
 	50,
 	26601712,
-	241,311
+	PAL_VBLANK_START,PAL_END_LINE
 };
 
 region_t region_dendy = {
 	REGION_DENDY,
 	50,
 	26601712,
-	291,311
+	DENDY_VBLANK_START,DENDY_END_LINE
 };
 
 void nes_set_region(int r)
@@ -59,4 +59,5 @@ void nes_set_region(int r)
 			break;
 	}
 	apu_set_region(r);
+	scheduler_set_region(r);
 }
@@ -26,6 +26,14 @@
 #define REGION_PAL	1
 #define REGION_DENDY	2
 
+//vblank start line and last line for each region
+#define NTSC_VBLANK_START	241
+#define NTSC_END_LINE		261
+#define PAL_VBLANK_START	241
+#define PAL_END_LINE			311
+#define DENDY_VBLANK_START	291
+#define DENDY_END_LINE		311
+
 typedef struct region_s {
 
 	//region id
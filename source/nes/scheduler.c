@@ -0,0 +1,209 @@
+/***************************************************************************
+ *   Copyright (C) 2013 by James Holodnak                                  *
+ *   jamesholodnak@gmail.com                                               *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include "misc/config.h"
+#include "nes/nes.h"
+
+#define SCHED		nes->scheduler
+#define CYCLES		nes->cpu.cycles
+
+//cpu cycles the ppu is behind by
+static INLINE u32 ppu_behind()
+{
+	u32 n = (u32)(CYCLES - SCHED.ppucycles);
+
+	SCHED.ppucycles = CYCLES;
+	return(n);
+}
+
+//run the ppu up to the current cpu cycle.  three dots per cycle, plus one
+//extra dot every fifth cycle on pal.
+static void sync_ppu_ntsc()
+{
+	ppu_run_ntsc(ppu_behind() * 3);
+}
+
+static void sync_ppu_pal()
+{
+	u32 dots = ppu_behind();
+
+	SCHED.palticks += dots;
+	dots = dots * 3 + SCHED.palticks / 5;
+	SCHED.palticks %= 5;
+	ppu_run_pal(dots);
+}
+
+static void sync_ppu_dendy()
+{
+	ppu_run_dendy(ppu_behind() * 3);
+}
+
+static INLINE void sync_ppu()
+{
+	if(SCHED.ppucycles < CYCLES)
+		SCHED.syncppu();
+}
+
+//run the apu up to the current cpu cycle
+static INLINE void sync_apu()
+{
+	while(SCHED.apucycles < CYCLES) {
+		SCHED.apucycles++;
+		apu_step();
+	}
+}
+
+//run the mapper irq counter up to the current cpu cycle
+static INLINE void sync_mapper()
+{
+	if(SCHED.mappercycles < CYCLES) {
+		nes->mapper->cpuclock((u32)(CYCLES - SCHED.mappercycles));
+		SCHED.mappercycles = CYCLES;
+	}
+}
+
+//convert ppu dots to cpu cycles, rounding so we never land past the event
+//(pal has an extra dot every 5 cycles, ntsc/dendy can skip one dot per frame)
+static INLINE u64 dots2cycles(u32 dots)
+{
+	u32 n;
+
+	if(nes->region->id & REGION_PAL)
+		n = (dots * 5 - 4) / 16;
+	else
+		n = (dots - 1) / 3;
+	return((n == 0) ? 1 : n);
+}
+
+static INLINE u64 apu_event(u32 n)
+{
+	return((n == EVENT_NEVER) ? (u64)-1 : SCHED.apucycles + n);
+}
+
+static INLINE void update_next()
+{
+	int i;
+
+	SCHED.next = SCHED.events[0];
+	for(i=1;i<EVENT_NUM;i++) {
+		if(SCHED.next > SCHED.events[i])
+			SCHED.next = SCHED.events[i];
+	}
+}
+
+void scheduler_set_region(int r)
+{
+	switch(r) {
+		default:
+		case REGION_NTSC:
+			SCHED.syncppu = sync_ppu_ntsc;
+			break;
+		case REGION_PAL:
+			SCHED.syncppu = sync_ppu_pal;
+			break;
+		case REGION_DENDY:
+			SCHED.syncppu = sync_ppu_dendy;
+			break;
+	}
+}
+
+void scheduler_reset()
+{
+	int i;
+
+	SCHED.ppucycles = SCHED.apucycles = SCHED.mappercycles = CYCLES;
+#ifdef LAZY_PPU
+	SCHED.eager = (nes->mapper->ppucycle != null_mapper_cycle || config_get_bool("nes.lazy_ppu") == 0) ? 1 : 0;
+#else
+	SCHED.eager = 1;
+#endif
+	for(i=0;i<EVENT_NUM;i++)
+		SCHED.events[i] = CYCLES + 1;
+	SCHED.next = CYCLES + 1;
+}
+
+static INLINE void update_ppu_events()
+{
+	if(SCHED.eager) {
+		SCHED.events[EVENT_PPU] = (u64)-1;
+		SCHED.events[EVENT_MAPPER] = SCHED.ppucycles + 1;
+	}
+	else {
+		SCHED.events[EVENT_PPU] = SCHED.ppucycles + dots2cycles(ppu_nextevent());
+		SCHED.events[EVENT_MAPPER] = (u64)-1;
+	}
+}
+
+static INLINE void update_apu_events()
+{
+	sync_apu();
+	SCHED.events[EVENT_FRAMEIRQ] = apu_event(apu_frame_nextevent());
+	SCHED.events[EVENT_DPCM] = apu_event(apu_dpcm_nextevent());
+}
+
+static INLINE void update_mapper_events()
+{
+	u32 n;
+
+	sync_mapper();
+	n = nes->mapper->cpuevent();
+	SCHED.events[EVENT_MAPPERIRQ] = (n == EVENT_NEVER) ? (u64)-1 : SCHED.mappercycles + n;
+}
+
+//called by cpu_tick when an event is due.  only the units with an event due
+//are caught up, the others keep running behind until they are needed.
+void scheduler_step()
+{
+	if(CYCLES >= SCHED.events[EVENT_PPU] || CYCLES >= SCHED.events[EVENT_MAPPER]) {
+		sync_ppu();
+		update_ppu_events();
+	}
+	if(CYCLES >= SCHED.events[EVENT_MAPPERIRQ])
+		update_mapper_events();
+	if(CYCLES >= SCHED.events[EVENT_FRAMEIRQ] || CYCLES >= SCHED.events[EVENT_DPCM])
+		update_apu_events();
+	update_next();
+}
+
+//catch everything up and return the cpu cycle of the next event
+u64 scheduler_nextevent()
+{
+	sync_ppu();
+	update_ppu_events();
+	update_mapper_events();
+	update_apu_events();
+	update_next();
+	return(SCHED.next);
+}
+
+//catch everything up to the current cpu cycle, used before register accesses
+//and at the end of a frame.  the access may move events around, so they are
+//all recalculated on the next cycle.
+void scheduler_sync()
+{
+	int i;
+
+	sync_ppu();
+	sync_mapper();
+	sync_apu();
+	for(i=0;i<EVENT_NUM;i++)
+		SCHED.events[i] = CYCLES + 1;
+	SCHED.next = CYCLES + 1;
+}
@@ -0,0 +1,69 @@
+/***************************************************************************
+ *   Copyright (C) 2013 by James Holodnak                                  *
+ *   jamesholodnak@gmail.com                                               *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#ifndef __nes__scheduler_h__
+#define __nes__scheduler_h__
+
+#include "types.h"
+
+//scheduled events, things the cpu can see without touching a register.
+//sprite 0 hit and the vblank flag are only visible through $2002, which
+//always catches the ppu up before it is read.
+#define EVENT_PPU			0		//vblank start (nmi), nmi line clear and end of frame
+#define EVENT_FRAMEIRQ	1		//apu frame irq
+#define EVENT_DPCM		2		//dpcm sample fetch
+#define EVENT_MAPPER		3		//mapper ppu cycle handler (irq counters)
+#define EVENT_MAPPERIRQ	4		//mapper cpu cycle irq counter
+#define EVENT_NUM			5
+
+//event will not happen without a register write
+#define EVENT_NEVER		0xFFFFFFFF
+
+typedef struct scheduler_s {
+
+	//cpu cycle the ppu/apu/mapper irq counter have been run up to
+	u64	ppucycles;
+	u64	apucycles;
+	u64	mappercycles;
+
+	//cpu cycle each event is due on
+	u64	events[EVENT_NUM];
+
+	//earliest event
+	u64	next;
+
+	//ppu is run every cycle (mapper has a ppu cycle handler or lazy ppu is off)
+	int	eager;
+
+	//pal cycle count towards the extra dot
+	u32	palticks;
+
+	//region specific ppu catch-up, set by scheduler_set_region
+	void	(*syncppu)();
+
+} scheduler_t;
+
+void scheduler_set_region(int r);
+void scheduler_reset();
+void scheduler_step();
+void scheduler_sync();
+u64 scheduler_nextevent();
+
+#endif
@@ -55,9 +55,14 @@ static u8 palettecache[32];
 static double interval = 0;
 static u64 lasttime = 0;
 
-//pointer to scree and copy of the nes screen
+//pointer to screen and the nes screen (palette indexes).  the nes screen is
+//normally the ppu's buffer, screenbuf is used until one is set.
 static u32 *screen = 0;
 static u8 *nesscreen = 0;
+static u8 *screenbuf = 0;
+
+//number of nes screen pixels already converted to rgb this frame
+static int converted = 0;
 
 //draw function pointer and pointer to current video filter
 static void (*drawfunc)(void*,u32,void*,u32,u32,u32);		//dest,destpitch,src,srcpitch,width,height
@@ -180,8 +185,10 @@ static int get_desktop_bpp()
 
 int video_init()
 {
+	if(screenbuf == 0)
+		screenbuf = (u8*)mem_alloc(256 * (240 + 16));
 	if(nesscreen == 0)
-		nesscreen = (u8*)mem_alloc(256 * (240 + 16));
+		nesscreen = screenbuf;
 
 	//setup timer to limit frames
 	interval = (double)system_getfrequency() / 60.0f;
@@ -255,10 +262,12 @@ void video_kill()
 	SDL_ShowCursor(1);
 	if(screen)
 		mem_free(screen);
-	if(nesscreen)
-		mem_free(nesscreen);
+	if(nesscreen == screenbuf)
+		nesscreen = 0;
+	if(screenbuf)
+		mem_free(screenbuf);
 	screen = 0;
-	nesscreen = 0;
+	screenbuf = 0;
 }
 
 int video_reinit()
@@ -271,12 +280,30 @@ void video_startframe()
 {
 	//lock sdl surface
 	SDL_LockSurface(surface);
+	converted = 0;
+}
+
+//convert the nes screen to rgb with the current palette, up to pixel 'end'
+static void convert_screen(int end)
+{
+	int i;
+
+	for(i=converted;i<end;i++)
+		screen[i] = palettecache32[nesscreen[i]];
+	if(end > converted)
+		converted = end;
 }
 
 void video_endframe()
 {
 	u64 t;
 
+	//convert the rest of the palette indexes drawn this frame, lines outside
+	//of 8-231 are blacked out
+	convert_screen(256 * 240);
+	memset(screen,0,256 * 8 * sizeof(u32));
+	memset(screen + (232 * 256),0,256 * 8 * sizeof(u32));
+
 	//draw everything
 	drawfunc(surface->pixels,surface->pitch,screen,256*4,256,240);
 	console_draw((u32*)surface->pixels,surface->pitch,screenh);
@@ -297,34 +324,27 @@ void video_endframe()
 //this handles lines for gui/status messages
 void video_updateline(int line,u8 *s)
 {
-	u32 *dest = screen + (line * 256);
-	int i;
-
 	memcpy(nesscreen + (line * 256),s,256);
-	if(line >= 8 && line < 232) {
-		for(i=0;i<256;i++) {
-			*dest++ = palettecache32[*s++];
-		}
-	}
-	else {
-		for(i=0;i<256;i++) {
-			*dest++ = 0;
-		}
-	}
 }
 
-//this handles pixels coming directly from the nes engine
+//this handles single pixels drawn outside of the nes engine, the ppu draws
+//into its own buffer (see video_setscreen)
 void video_updatepixel(int line,int pixel,u8 s)
 {
-	int offset = (line * 256) + pixel;
+	nesscreen[(line * 256) + pixel] = s;
+}
 
-	nesscreen[offset] = s;
-	if(line >= 8 && line < 232) {
-		screen[offset] = palettecache32[s];
-	}
-	else {
-		screen[offset] = 0;
-	}
+//set the buffer of palette indexes converted each frame (0 for our own)
+void video_setscreen(u8 *s)
+{
+	nesscreen = (s == 0) ? screenbuf : s;
+}
+
+//the first 'pixels' pixels of the nes screen are final for this frame, convert
+//them before the palette changes under them
+void video_updatescreen(int pixels)
+{
+	convert_screen(pixels);
 }
 
 //this handles palette changes from the nes engine
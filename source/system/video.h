@@ -29,6 +29,8 @@ int video_reinit();
 void video_startframe();
 void video_endframe();
 void video_updatepixel(int line,int pixel,u8 s);
+void video_setscreen(u8 *s);
+void video_updatescreen(int pixels);
 void video_updatepalette(u8 addr,u8 data);
 void video_setpalette(palette_t *p);
 int video_getwidth();
@@ -24,6 +24,7 @@
 #include <windowsx.h>
 #include <ddraw.h>
 #include <stdio.h>
+#include <string.h>
 
 extern "C" {
 	#include "misc/log.h"
@@ -45,8 +46,19 @@ LPDIRECTDRAWCREATEEX DirectDrawCreateEx;
 #endif
 
 static u8 *nesscreen = 0;
+static u8 *screenbuf = 0;
 static u16 *screen16;
 static u32 *screen32;
+
+//number of nes screen pixels already converted this frame
+static int converted = 0;
+
+//raw rgb pixels drawn over the nes screen this frame, put on top of the
+//converted screen at the end of the frame (see video_updaterawpixel)
+static u32 rawpixels[256 * 240];
+static u8 rawmask[256 * 240];
+static int rawcount = 0;
+
 static void *screen;
 static int screenw,screenh,screenbpp;
 static int screenscale;
@@ -288,9 +300,12 @@ static int initvideo()
 	POINT pt = {0, 0};
 	int i,ret;
 
-	//nesscreen is nes screen data (raw palette indexes)
+	//nesscreen is nes screen data (raw palette indexes), normally the ppu's
+	//buffer.  screenbuf is used until one is set.
+	if(screenbuf == 0)
+		screenbuf = (u8*)mem_alloc(256 * (240 + 16));
 	if(nesscreen == 0)
-		nesscreen = (u8*)mem_alloc(256 * (240 + 16));
+		nesscreen = screenbuf;
 
 	//copy of unfiltered screen data (ready for output)
 	if(screen == 0)
@@ -404,9 +419,11 @@ int video_init()
 
 void video_kill()
 {
-	if(nesscreen) {
-		mem_free(nesscreen);
+	if(nesscreen == screenbuf)
 		nesscreen = 0;
+	if(screenbuf) {
+		mem_free(screenbuf);
+		screenbuf = 0;
 	}
 	if(screen) {
 		mem_free(screen);
@@ -442,6 +459,54 @@ int video_reinit()
 void video_startframe()
 {
 	lpSecondaryDDS->Lock(NULL,&ddsd,DDLOCK_WAIT | DDLOCK_NOSYSLOCK | DDLOCK_WRITEONLY,NULL);
+	converted = 0;
+}
+
+//convert the nes screen to the output format with the current palette, up to pixel 'end'
+static void convert_screen(int end)
+{
+	int i;
+
+	switch(screenbpp) {
+		case 15:
+		case 16:
+			for(i=converted;i<end;i++)
+				screen16[i] = palettecache16[nesscreen[i]];
+			break;
+		case 32:
+			for(i=converted;i<end;i++)
+				screen32[i] = palettecache32[nesscreen[i]];
+			break;
+	}
+	if(end > converted)
+		converted = end;
+}
+
+#define MAKERGB555(pp) \
+	(((pp) >> (3 + 0)) << 0) | \
+	(((pp) >> (3 + 8)) << 5) | \
+	(((pp) >> (3 + 16)) << 10);
+
+//put the raw pixels drawn this frame over the converted screen
+static void draw_rawpixels()
+{
+	int i;
+
+	for(i=0;i<256*240;i++) {
+		if(rawmask[i] == 0)
+			continue;
+		switch(screenbpp) {
+			case 15:
+			case 16:
+				screen16[i] = MAKERGB555(rawpixels[i]);
+				break;
+			case 32:
+				screen32[i] = rawpixels[i];
+				break;
+		}
+	}
+	memset(rawmask,0,sizeof(rawmask));
+	rawcount = 0;
 }
 
 void video_endframe()
@@ -450,6 +515,11 @@ void video_endframe()
 	POINT pt = {0, 0};
 	u64 t;
 
+	//convert the rest of the palette indexes drawn this frame
+	convert_screen(256 * 240);
+	if(rawcount)
+		draw_rawpixels();
+
 	//blit screen to surface
 	drawfunc(ddsd.lpSurface,ddsd.lPitch,screen,256*4,256,240);
 
@@ -507,41 +577,35 @@ void video_endframe()
 	}
 }
 
-//this handles pixels coming directly from the nes engine
+//this handles single pixels drawn outside of the nes engine, the ppu draws
+//into its own buffer (see video_setscreen)
 void video_updatepixel(int line, int pixel, u8 s)
 {
-	int offset = (line * 256) + pixel;
-
-	nesscreen[offset] = s;
-	switch (screenbpp) {
-	case 15:
-	case 16:
-		screen16[offset] = palettecache16[s];
-		break;
-	case 32:
-		screen32[offset] = palettecache32[s];
-		break;
-	}
+	nesscreen[(line * 256) + pixel] = s;
 }
 
-#define MAKERGB555(pp) \
-	(((pp) >> (3 + 0)) << 0) | \
-	(((pp) >> (3 + 8)) << 5) | \
-	(((pp) >> (3 + 16)) << 10);
+//set the buffer of palette indexes converted each frame (0 for our own)
+void video_setscreen(u8 *s)
+{
+	nesscreen = (s == 0) ? screenbuf : s;
+}
 
+//the pixel is kept until the end of the frame so the conversion of the nes
+//screen doesn't overwrite it
 extern "C" void video_updaterawpixel(int line, int pixel, u32 s)
 	{
 	int offset = (line * 256) + pixel;
 
-	switch (screenbpp) {
-	case 15:
-	case 16:
-		screen16[offset] = MAKERGB555(s);
-		break;
-	case 32:
-		screen32[offset] = s;
-		break;
-	}
+	rawpixels[offset] = s;
+	rawmask[offset] = 1;
+	rawcount++;
+}
+
+//the first 'pixels' pixels of the nes screen are final for this frame, convert
+//them before the palette changes under them
+void video_updatescreen(int pixels)
+{
+	convert_screen(pixels);
 }
 
 //this handles palette changes from the nes engine
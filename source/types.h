@@ -24,9 +24,11 @@
 #if defined(_MSC_VER)
 	#define int64 __int64
 	#define INLINE __inline
+	#define THREADLOCAL __declspec(thread)
 #elif defined(__GNUC__)
 	#define int64 long long
 	#define INLINE inline
+	#define THREADLOCAL __thread
 #else
 	#error unknown compiler.  please #define int64.
 #endif